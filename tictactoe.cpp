@@ -1,889 +1,6144 @@
-/**
- * @file    tictactoe.cpp
- */
-/**\mainpage
- * @brief Tic-Tac-Toe AI in C++11.
- *
- * This little program has been written as a solution to a tic-tac-toe
- * exercise on the French C++ forum of the siteduzero.com.
- *
- * It implements two AI strategies:
- * [negamax](http://en.wikipedia.org/wiki/Negamax), and negamax with
- * alpha/beta pruning:
- * [negascout](http://en.wikipedia.org/wiki/Negascout). It lets the user
- * the possibility to play against the machine, or two AIs to play
- * against each other.
- *
- * @note 
- * I took this exercise as an excuse to play with a few C++11 features:
- * <code>enum class</code>, tuples, rvalue-references, \c
- * std::unique_ptr<>, \em etc.
- *
- * @author Copyright 2011,2013 Luc Hermitte
- * <p><b>Licence</b> GPL v3.0.
- *
- * This program is free software: you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation, either version 3 of the License, or (at
- * your option) any later version.
- *
- * This program is distributed in the hope that it will be useful, but
- * WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
- * General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License
- * along with this program.  If not, see <http://www.gnu.org/licenses/>.
- */
-
-#include <string>
-#include <vector>
-#include <stdexcept>
-#include <limits>
-#include <tuple>
-#include <memory>
-#include <fstream>
-#include <ostream>
-#include <iostream>
-#include <cstdlib>
-
-#include <cassert>
-
-#define DEBUG_AI_LEVEL 0
-
-/**@defgroup gPlayer Player related definitions */
-/**@defgroup gGame Game related definitions */
-
-/**@defgroup gPlayerId Player Identifier
- *\ingroup gPlayer
- *@{
- */
-/// Player Id.
-enum class PlayerId {
-    first=1, second=2
-};
-/// Operator to iterate over players.
-PlayerId operator++(PlayerId &id, int) {
-    PlayerId tmp = id;
-    id=PlayerId(3-size_t(id));
-    return tmp;
-}
-/// Displays what the player uses on the board ('X', or 'O').
-std::ostream & operator<<(std::ostream & os, const PlayerId & v) {
-    const char c = (v==PlayerId::first ? 'X' : 'O');
-    return os << c;
-}
-//@}
-
-/**@defgroup gSquares Squares from the Board
- *\ingroup gGame
- *@{
- */
-/** Value of a square.
- * A square on the board may be %unoccupied, or occupied by a token of
- * any player.
- */
-enum class SquareValue {
-    unoccupied  =0,
-    first =PlayerId::first,
-    second=PlayerId::second
-};
-
-/** %Square on the \c Board.
- * This helper class holds the value of a square, and provides
- * a conversion function to display the square content.
- */
-struct Square {
-    /// Init constructor.
-    Square(SquareValue v = SquareValue::unoccupied) : m_value(v) {}
-    /// Value accessor.
-    SquareValue value() const { return m_value; }
-    /// Conversion function to a displayable character.
-    char as_char() const {
-        switch (m_value) {
-            case SquareValue::first: return 'X';
-            case SquareValue::second: return 'O';
-            case SquareValue::unoccupied: return ' ';
-        }
-        assert(!"Invalid value");
-    }
-private:
-    SquareValue m_value;
-};
-/// Displays the content of a square.
-std::ostream& operator<<(std::ostream& os, Square c) {
-    return os << c.as_char();
-}
-//@}
-
-/*===========================================================================*/
-/*==============================[ Coordinates ]==============================*/
-/*===========================================================================*/
-/**@defgroup gCoordinate Coordinates of Squares on the Board
- *\ingroup gGame
- *@{
- */
-/** Coordinates definition.
- * As a tuple (row x column)
- */
-typedef std::tuple<size_t, size_t>       Coords;
-/** Distance vector between two Squares.
- */
-typedef std::tuple<ptrdiff_t, ptrdiff_t> Delta;
-
-/// Increments a coordinates pair.
-Coords     & operator+=(Coords& c, Delta const& d) {
-    std::get<0>(c) += std::get<0>(d);
-    std::get<1>(c) += std::get<1>(d);
-    return c;
-}
-Coords const operator+ (Coords  c, Delta const& d) {
-    return c+=d;
-}
-
-/// Decrements a coordinates pair.
-Coords     & operator-=(Coords& c, Delta const& d) {
-    std::get<0>(c) -= std::get<0>(d);
-    std::get<1>(c) -= std::get<1>(d);
-    return c;
-}
-Coords const operator- (Coords  c, Delta const& d) {
-    return c-=d;
-}
-
-/// Tells whether \f$0<= c_1<M_1\f$ and \f$0<=c_2<M_2\f$
-bool in_range(Coords const& c, Coords const& M) {
-    return std::get<0>(c) >= 0
-        && std::get<1>(c) >= 0
-        && std::get<0>(c) <  std::get<0>(M)
-        && std::get<1>(c) <  std::get<1>(M);
-}
-
-std::ostream& operator<<(std::ostream&os, Coords const& c) {
-    return os << '{' << std::get<0>(c) << ',' << std::get<1>(c) << '}';
-}
-//@}
-
-
-/*===========================================================================*/
-/*=================================[ Board ]=================================*/
-/*===========================================================================*/
-/**@defgroup gBoard Board related definitions
- * @ingroup gGame
- * @{
- */
-/** %Board Definition.
- * A board is made of \c L_ x \c C_ \link Square squares\endlink.
- *
- * We can:
- * - sets the value of a square
- * - interrogates the value of a square
- */
-struct Board
-{
-    /// Init constructor.
-    Board(size_t L_, size_t C_)
-        : m_board(L_*C_), m_L(L_), m_C(C_) {}
-    /// Init constructor for square boards.
-    Board(size_t L_=3)
-        : m_board(L_*L_), m_L(L_), m_C(L_) {}
-    // Board(Board && tmp)
-
-    /// \c Square accessor.
-    Square const& operator()(size_t l, size_t c) const {
-        return board(l,c);
-    }
-    /// \c Square accessor.
-    Square const& operator()(Coords c) const {
-        return board(std::get<0>(c), std::get<1>(c));
-    }
-
-    /// Is a \c Square unoccupied ?
-    bool is_empty(size_t l, size_t c) const {
-        return board(l,c).value() == SquareValue::unoccupied;
-    }
-    /** Occupies a \c Square with a player's move.
-     * @pre the square must be unoccupied.
-     * @post <tt>board(l,c) == v</tt>
-     * @return whether the operation has succeeded
-     */
-    bool set(size_t l, size_t c, SquareValue v) {
-        if (board(l,c).value() != SquareValue::unoccupied) {
-            return false;
-        }
-        board(l,c) = v;
-        return true;
-    }
-    /** Occupies a \c Square with a player's move.
-     * @pre the square must be unoccupied.
-     * @post <tt>board(c) == v</tt>
-     * @return whether the operation has succeeded
-     */
-    bool set(Coords const& c, SquareValue v) {
-        return set(std::get<0>(c), std::get<1>(c), v);
-    }
-    /** Clears a \c Square.
-     * @post <tt>board(l,c) == SquareValue::unoccupied</tt>
-     */
-    void reset(size_t l, size_t c) {
-        board(l,c) = SquareValue::unoccupied;
-    }
-    /** Clears a \c Square.
-     * @post <tt>board(c) == SquareValue::unoccupied</tt>
-     */
-    void reset(Coords const& c) {
-        reset(std::get<0>(c), std::get<1>(c));
-    }
-
-    /// Maximum number of rows of the board.
-    size_t L() const { return m_L; }
-    /// Maximum number of columns of the board.
-    size_t C() const { return m_C; }
-    /// Coordinates of the bottom-right.
-    Coords M() const { return Coords{L(), C()}; }
-private:
-    /** Internal \c Square accessor.
-     * @pre <tt>l < L()</tt>, checked with an assertion
-     * @pre <tt>c < C()</tt>, checked with an assertion
-     */
-    Square      & board(size_t l, size_t c) {
-        assert(l < L());
-        assert(c < C());
-        return m_board[l*C()+c];
-    }
-    Square const& board(size_t l, size_t c) const {
-        return const_cast <Board*>(this)->board(l,c);
-    }
-    std::vector<Square> m_board;
-    size_t            m_L;
-    size_t            m_C;
-};
-
-/// Helper function to draw an line of +-+-+-+...+.
-std::ostream & draw_line(std::ostream& os , size_t C)
-{
-    os << '+';
-    for (size_t c=0; c!=C ; ++c) 
-        os << "-+";
-    return os;
-}
-
-/// Displays a \c Board on a text stream.
-std::ostream& operator<<(std::ostream&os, Board const& b) {
-    draw_line(os, b.C());
-    for (size_t l=0; l!=b.L() ; ++l) {
-        os << "\n|";
-        for (size_t c=0; c!=b.C() ; ++c) {
-            os << b(l,c) << '|';
-        }
-        draw_line(os<<'\n', b.C());
-    }
-    return os << '\n';
-}
-//@}
-
-/*===========================================================================*/
-/*========================[ Player Decision Centres ]========================*/
-/*===========================================================================*/
-struct Game;
-
-/**@addtogroup gPlayer
- *@{
- */
-/**@defgroup gPlayerAI Player AI */
-/**@ingroup gPlayerAI
- * Interface class for Player Decision Centres.
- * Human players, and AI players all share the same interface when
- * considering their decisions: they are asked what move they \c choose
- * to perform.
- * @note non copyable.
- */
-struct PlayerDC
-{
-    virtual ~PlayerDC() {};
-    /**
-     * Chooses the next move.
-     * This function is to be specialized depending on the actual kind
-     * of player (humain, or various AI algorithms). This is where the
-     * actual decision will be made
-     * @param[in,out] g  Game current state. 
-     * @return Next move chosen
-     */
-    virtual Coords choose(Game & g) const = 0;
-
-protected:
-    PlayerDC() {}
-    PlayerDC           (PlayerDC const&) = delete;
-    PlayerDC& operator=(PlayerDC const&) = delete;
-};
-
-/** Actual player class.
- * The \em strategy Design Pattern is implemented regarding how players
- * decide of their next move.
- */
-struct Player
-{
-    /**
-     * %Player init constructor.
-     * @param[in] dc_  Decision centre for the player. 
-     * @param[in] name_  Name of the new player.
-     *
-     * @pre \c dc_ is not null, checked with an assertion
-     * @note \c dc_ responsibility is moved to the new \c Player
-     * instance.
-     */
-    Player(std::unique_ptr<PlayerDC>&& dc_, std::string && name_)
-        : m_dc(std::move(dc_))
-        , m_name(name_)
-        {
-            assert(m_dc);
-        }
-    /** Choose the next move.
-     * The actual choice is given to the exact \link PlayerDC decision
-     * centre\endlink instantiated.
-     * @param[in,out] g  Game current state. 
-     * @return Next move chosen
-     * @see \c PlayerDC::choose()
-     */
-    Coords choose(Game & g) const { return m_dc->choose(g); }
-    /// Name accessor.
-    std::string const& name() const { return m_name; }
-private:
-    std::unique_ptr<PlayerDC> m_dc;
-    std::string               m_name;
-};
-
-/// Displays a player's name.
-std::ostream & operator<<(std::ostream & os, const Player & v) {
-    return os << v.name();
-}
-//@}
-
-
-/*===========================================================================*/
-/*=================================[ Game ]==================================*/
-/*===========================================================================*/
-/**@addtogroup gGame
- *@{
- */
-/** %Game state.
- * This class aggregates all data about the current state of a game:
- * - the state of the \c Board,
- * - the list of \link Player players\endlink,
- * - the current number of moves accomplished,
- * - the number of aligned player tokens required to declare a win.
- */
-struct Game
-{
-    /// Init constructor.
-    Game(size_t L_=3, size_t C_=0, size_t nb_required_to_win = 0)
-        : m_nb_moves(0)
-        , m_board(L_, C_?C_:L_)
-        , m_nb_required_to_win(nb_required_to_win ? nb_required_to_win : L_)
-        {}
-
-    /// Checks whether the \c Square at coordinates {l,c} is unoccupied.
-    bool can_play_at(size_t l, size_t c) const {
-        return m_board.is_empty(l,c);
-    }
-    /// Assigns a \c Square with a player token. 
-    bool set(Coords c, PlayerId p) {
-        return m_board.set(c,SquareValue(size_t(p)));
-    }
-    /// Empties a \c Square of any a player token. 
-    void reset(Coords const& c) {
-        m_board.reset(c);
-    }
-
-    /** Iterates over all possible moves, and applies a functor on the
-     *  game state.
-     * This is a special \c for_each that iterates over possible moves
-     * from current game state.
-     * @param[in] f  functor to apply on new game states built from each
-     * possible moves.
-     * @throw Whatever f may throw
-     * @return as soon as \c f() returns \c true.
-     */
-    template <class F> void for_each_possible_move(F f) {
-        bool cont = true;
-        for (size_t l=0; cont && l!=m_board.L() ; ++l)
-            for (size_t c=0; cont && c!=m_board.C() ; ++c)
-                if(can_play_at(l,c))
-                    cont = f(Coords{l,c});
-    }
-
-    /** Checks whether a given move is a winning move.
-     * @param[in] c  coordinate where a new player token shall be
-     * evaluated 
-     * @param[in] p  id of the player to consider playing
-     * @return whether player \c p wins if she plays at \c c.
-     * @throw None
-     */
-    bool is_a_winning_move_for(Coords c, PlayerId p) const {
-        const SquareValue v = SquareValue(size_t(p)) ;
-        // vert
-        if (check_orth<0>(c,v)) { return true; }
-        // horiz
-        if (check_orth<1>(c,v)) { return true; }
-        // diag 1
-        if (check_diag(c,v, Delta{1, 1})) { return true; }
-        // diag 2
-        if (check_diag(c,v, Delta{1, -1})) { return true; }
-        return false;
-    }
-
-    /** Adds a new player to the game.
-     * @param[in] player  New player (decision centre) to add, and takes
-     * responsibility of.
-     * @param[in] name    Name of the new player.
-     * @pre the \c player shall not be null, checked by assertion.
-     * @throw std::bad_alloc if memory is exhausted.
-     */
-    void push(std::unique_ptr<PlayerDC> && player, std::string && name) {
-        assert(player);
-        m_players.push_back(Player(std::move(player), std::move(name)));
-    }
-
-    /**
-     * Game main function.
-     * This function iterates until a player wins, or there is a draw.
-     * @pre The number of registered players shall be 2; unchecked.
-     * @post Either one player has won, or a draw has been established.
-     */
-    void run()
-    {
-        PlayerId player = m_nb_moves%2 == 0 ? PlayerId::first : PlayerId::second;
-        while (m_nb_moves != L() * C()) {
-            Player & p =  m_players[size_t(player)-1];
-            std::cout
-                <<"Moves: " << m_nb_moves
-                << " ; Player " << size_t(player) << ", " << p.name() << ", ";
-            Coords c = p.choose(*this);
-            assert(in_range(c, board().M())); // choose() post constract
-            if (set(c, player)) {
-                std::cout << board();
-                if (is_a_winning_move_for(c, player)) {
-                    std::cout << "Player " << size_t(player) << ", " << p.name() << ", has won!\n";
-                    return;
-                }
-                player++;
-                m_nb_moves ++;
-            } else {
-                std::cout << "Cannot play there, try again.\n";
-            }
-        }
-        std::cout << "Draw. Nobody wins.\n";
-    }
-
-    /// Internal Board accessor.
-    Board const& board() const { return m_board; }
-    /// Accessor to the number of rows in the board.
-    size_t       L()     const { return m_board.L(); }
-    /// Accessor to the number of columns in the board.
-    size_t       C()     const { return m_board.C(); }
-    /// Accessor to the dimension of the board.
-    Coords       M()     const { return m_board.M(); }
-private:
-
-    /** Checks whether there a win on the row/column.
-     * @tparam Dir direction searched (row or column)
-     * @param[in] c  coordinates where a new token is evaluated whether
-     * it is a winning token
-     * @param[in] v  id of the player who own the token evaluated.
-     *
-     * @return whether this is a winning move horizontally (Dir==0), or
-     * vertically (Dir==1).
-     * @throw None.
-     */
-    template <size_t Dir> bool check_orth(Coords c, const SquareValue v) const
-    {
-        size_t nb = 1; // crt
-        for (Coords t = c ; std::get<Dir>(t) > 0 ; ++nb) {
-            std::get<Dir>(t)-- ;
-            if ((m_board)(t).value() != v) break;
-        }
-        for (Coords t = c ; std::get<Dir>(t) < std::get<Dir>(m_board.M())-1 ; ++nb) {
-            std::get<Dir>(t)++ ;
-            if ((m_board)(t).value() != v) break;
-        }
-        return (nb >= m_nb_required_to_win) ;
-    }
-
-    /** Checks whether there a win on the diagonal.
-     * @param[in] c  coordinates where a new token is evaluated whether
-     * it is a winning token
-     * @param[in] v  id of the player who own the token evaluated.
-     * @param[in] d  orientation of the diagonal where to search for a
-     * winning move.
-     *
-     * @return whether this is a winning move.
-     * @throw None.
-     */
-    bool check_diag(Coords c, SquareValue v, Delta d) const {
-        size_t nb = 1; // crt
-        for (Coords t = c ; ; ++nb) {
-            t -= d;
-            if (!in_range(t, m_board.M()))  break; 
-            if ((m_board)(t).value() != v) break;
-        }
-        for (Coords t = c ; ; ++nb) {
-            t += d;
-            if (!in_range(t, m_board.M()))  break; 
-            if ((m_board)(t).value() != v) break;
-        }
-        return (nb >= m_nb_required_to_win) ;
-    }
-
-    /**@name Game dynamic data
-     * Data that define the current state of the game.
-     * They evolve during the game.
-     */
-    //@{
-    size_t              m_nb_moves;
-    Board               m_board;
-    //@}
-    /**@name Game static data */
-    //@{
-    size_t              m_nb_required_to_win;
-    std::vector<Player> m_players;
-    //@}
-
-    friend std::istream & operator>>(std::istream & is,  Game & v);
-};
-
-std::istream & operator>>(std::istream & is,  Game & v)
-{
-    std::vector<std::string> lines;
-    std::string line;
-    size_t C;
-    while (std::getline(is, line)) { // till eof
-        if (line[0] == '|') {
-            lines.push_back(line);
-            C =  (line.size()-1)/2;
-        } else if (line == "<<EOF") {
-            break;
-        }
-    }
-    // if (is) {
-        Board b(lines.size(), C);
-        v.m_nb_moves = 0;
-        for (size_t l=0, L=b.L(); l!=L ; ++l) {
-            for (size_t c=0,C=b.C(); c!=C ; ++c) {
-                switch (lines[l][c*2+1]) {
-                    case 'X':
-                        b.set(l,c,SquareValue::first);
-                        v.m_nb_moves++;
-                        break;
-                    case 'O':
-                        b.set(l,c,SquareValue::second);
-                        v.m_nb_moves++;
-                        break;
-                }
-            }
-        }
-        // std::cout << b;
-        v.m_board = std::move(b);
-    // }
-    return is ;
-}
-//@}
-
-/*===========================================================================*/
-/*========================[ Player Decision Centres ]========================*/
-/*===========================================================================*/
-
-/*===============================[ LocalPlayerDC : cin/cout ]================*/
-/**@ingroup gPlayerAI
- * Player decision centre that delegates decisions to a human player
- * through text console.
- */
-struct LocalPlayerDC : PlayerDC {
-    virtual Coords choose(Game & g) const {
-        size_t l, c;
-        while (! (std::cout << "Where? (row col)" && (std::cin >> l >> c) && l<g.L() && c<g.C())) {
-            if (std::cin.eof()) {
-                throw std::runtime_error("\nAh ah, you gave up!");
-            } else if (std::cin.fail()) {
-                std::cin.clear();
-                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                std::cout << "Invalid numbers, try again: ";
-            } else if (l>=g.L()) {
-                std::cout << "line out of range [0,"<<g.L()<<"[, try again: ";
-            } else if (c>=g.C()) {
-                std::cout << "column out of range [0,"<<g.C()<<"[, try again: ";
-            } else {
-                assert(!"unexpected case");
-            }
-        }
-        return Coords{l, c};
-    }
-};
-
-/*===============================[ AIPlayerDC : negamax ]====================*/
-/**@ingroup gPlayerAI
- * Player decision centre implemented with the negamax algorithm.
- * @see http://en.wikipedia.org/wiki/Negamax
- */
-struct NegaMaxPlayerDC : PlayerDC
-{
-    NegaMaxPlayerDC(size_t depth, PlayerId id) : m_depth(depth), m_id(id) {}
-
-    virtual Coords choose(Game & g) const {
-        Coords best=g.M();
-        int max = std::numeric_limits<int>::min();
-        g.for_each_possible_move([&](Coords const& where) -> bool
-            {
-                g.set(where,this->m_id); // push the current move
-                int eval = - this->negamax(g, this->m_depth, this->m_id, where);
-                g.reset(where);   // pop the move
-                if (eval > max) {
-                    max = eval;
-                    best = where;
-                }
-                return true; // continue
-            });
-        std::cout << "negamax plays at " << best << " (" << max << ")\n";
-        if (max > +950)
-            std::cout << "You'll loose!\n";
-        else if (max < -950)
-            std::cout << "You should win...\n";
-        return best;
-    }
-private:
-    int negamax(Game & g, size_t depth, PlayerId who, Coords const& current) const noexcept
-    {
-#if DEBUG_AI_LEVEL > 0
-        const std::string indent (4*(6-depth), ' ');
-        std::cout << indent << "negamax(" << current << ", " <<depth<<", "<<who
-            // << ", alpha="<<alpha << ", beta= "<<beta
-            << ")\n";
-#if DEBUG_AI_LEVEL > 1
-        std::cout << g.board();
-#endif
-#endif
-
-        // terminal conditions => heuristic
-        if (g.is_a_winning_move_for(current, who)) {
-            // const int found = (1000) * (who==this->m_id ? 1 : -1);
-            const int found = -(1000) + depth;
-#if DEBUG_AI_LEVEL > 0
-            std::cout << indent << "  "<<current<<"-> ... winning move => "<<found<<"("<<who<< ")\n" ;
-#endif
-            return found;
-        } else if (depth == 0) {
-#if DEBUG_AI_LEVEL > 0
-            std::cout << indent << "  "<<current<<"-> ... exploration leaf => "<<0<<"("<<who<< ")\n" ;
-#endif
-            return 0; // should return how many openings there are
-        }
-
-        // else loop on all children nodes
-        int max = std::numeric_limits<int>::min();
-#if DEBUG_AI_LEVEL > 0
-        Coords best=g.M();
-#endif
-        PlayerId adv = who; adv ++;
-        g.for_each_possible_move(
-            [&](Coords const& child_node) -> bool {
-                g.set(child_node,adv); // push the current move
-                int eval = - this->negamax(g, depth-1, adv, child_node);
-                g.reset(child_node);   // pop the move
-                if (eval > max) {
-                    max = eval;
-#if DEBUG_AI_LEVEL > 0
-                    best= child_node;
-#endif
-                }
-                return true; // continue
-            });
-        if (max == std::numeric_limits<int>::min()) { // no child node
-            max = 0;
-        }
-#if DEBUG_AI_LEVEL > 0
-        std::cout << indent << "  "<<current<<"-> best move="<<best<<" => "<<max<<"("<<who<< ")\n" ;
-#endif
-        return max;
-    }
-
-    const size_t   m_depth;
-    const PlayerId m_id;
-};
-
-
-/*===============================[ AIPlayerDC : negamax alpha-beta ]=========*/
-/**@ingroup gPlayerAI
- * Player decision centre implemented with the negamax with alplha/beta algorithm, aka negascout.
- * @see http://en.wikipedia.org/wiki/Negascout
- */
-struct NegaMaxPlayerAlphaBetaDC : PlayerDC
-{
-    NegaMaxPlayerAlphaBetaDC(size_t depth, PlayerId id) : m_depth(depth), m_id(id) {}
-
-    virtual Coords choose(Game & g) const {
-#if DEBUG_AI_LEVEL > 0
-        std::cout << "\n";
-#endif
-        Coords best=g.M();
-        int max = std::numeric_limits<int>::min();
-        int alpha = -1000;
-        int beta  = +1000;
-        g.for_each_possible_move([&](Coords const& where) -> bool {
-                g.set(where,this->m_id); // push the current move
-                int eval = - this->negamax(g, this->m_depth, this->m_id, where, -beta, -alpha);
-                g.reset(where);   // pop the move
-                if (eval > max) {
-                    max = eval;
-                    best = where;
-                }
-                if (eval > alpha) {
-                    alpha = eval;
-                    if (alpha >= beta) {
-                        return false; // abort loop
-                    }
-                }
-                return true; // continue
-            });
-        std::cout << "negamax plays at " << best << " (" << max << ")\n";
-        if (max > +950)
-            std::cout << "You'll loose!\n";
-        else if (max < -950)
-            std::cout << "You should win...\n";
-        return best;
-    }
-private:
-    int negamax(Game & g, size_t depth, PlayerId who, Coords const& current, int alpha, int beta) const noexcept
-    {
-#if DEBUG_AI_LEVEL > 0
-        const std::string indent (4*(6-depth), ' ');
-        std::cout << indent << "negamax(" << current << ", " <<depth<<", "<<who
-            // << ", alpha="<<alpha << ", beta= "<<beta
-            << ")\n";
-#if DEBUG_AI_LEVEL > 1
-        std::cout << g.board();
-#endif
-#endif
-
-        // terminal conditions => heuristic
-        if (g.is_a_winning_move_for(current, who)) {
-            // const int found = (1000) * (who==this->m_id ? 1 : -1);
-            const int found = -(1000) + depth;
-            // todo: find a way to shorten the suffering! (+depth is not
-            // enough)
-#if DEBUG_AI_LEVEL > 0
-            std::cout << indent << "  "<<current<<"-> ... winning move => "<<found<<"("<<who<< ")\n" ;
-#endif
-            return found;
-        } else if (depth == 0) {
-#if DEBUG_AI_LEVEL > 0
-            std::cout << indent << "  "<<current<<"-> ... exploration leaf => "<<0<<"("<<who<< ")\n" ;
-#endif
-            return 0; // should return how many openings there are
-        }
-
-        // else loop on all children nodes
-        int max = std::numeric_limits<int>::min();
-#if DEBUG_AI_LEVEL > 0
-        Coords best=g.M();
-#endif
-        PlayerId adv = who; adv ++;
-        g.for_each_possible_move(
-            [&](Coords const& child_node) -> bool {
-                g.set(child_node,adv); // push the current move
-                int eval = - this->negamax(g, depth-1, adv, child_node, -beta, -alpha);
-                g.reset(child_node);   // pop the move
-                if (eval > max) {
-                    max = eval;
-#if DEBUG_AI_LEVEL > 0
-                    best= child_node;
-#endif
-                }
-                if (eval > alpha) {
-                    alpha = eval;
-                    if (alpha >= beta) {
-                        return false; // abort loop
-                    }
-                }
-                return true; // continue
-            });
-        if (max == std::numeric_limits<int>::min()) { // no child node
-            max = 0;
-        }
-#if DEBUG_AI_LEVEL > 0
-        std::cout << indent << "  "<<current<<"-> best move="<<best<<" => "<<max<<"("<<who<< ")\n" ;
-#endif
-        return max;
-    }
-
-    const size_t   m_depth;
-    const PlayerId m_id;
-};
-
-
-
-/*===========================================================================*/
-/*=================================[ main ]==================================*/
-/*===========================================================================*/
-/** Program main function.
- * @param \-\-board to load a file of a game. (optional)
- * @param player1 type of player (n -> negamax, a -> negamax+alpha-beta,
- * h -> human)
- * @param player2 type of player (n -> negamax, a -> negamax+alpha-beta,
- * h -> human)
- * @return \c EXIT_SUCCES if the execution succeeded
- * @return \c EXIT_FAILURE otherwise
- */
-int main (int argc, char **argv)
-{
-    if (argc < 3) {
-        std::cout << "Usage: " << argv[0] << " [options] <player> <player>"
-            << "\n\t[options]"
-            << "\n\t\t--board <filename>"
-            << "\n\t<player>"
-            << "\n\t\tn==ai player, (n)egamax"
-            << "\n\t\ta==ai player, negamax-(a)lphabeta"
-            << "\n\t\th==(h)uman player";
-        return EXIT_FAILURE;
-    }
-    try
-    {
-        Game g(8,8,4);
-        PlayerId id = PlayerId::first;
-        for (int i=1; i!=argc ; ++i) {
-            const std::string opt=argv[i];
-            if (opt == "--board" || opt=="-b") {
-                std::ifstream f(argv[++i]);
-                if (!f) {
-                    throw std::runtime_error("Cannot open " + std::string(argv[i]));
-                }
-                f >> g;
-            } else if (opt == "n" || opt=="negamax") {
-                g.push(std::unique_ptr<PlayerDC>(new NegaMaxPlayerDC(3, id)), "(AI-negamax)");
-                id++;
-            } else if (opt == "a" || opt=="negamax-ab") {
-                g.push(std::unique_ptr<PlayerDC>(new NegaMaxPlayerAlphaBetaDC(5, id)), "(AI-negamax-AB)");
-                id++;
-            } else if (opt == "h" || opt=="human") {
-                g.push(std::unique_ptr<PlayerDC>(new LocalPlayerDC()), "(Human)");
-                id++;
-            } else {
-                g.push(std::unique_ptr<PlayerDC>(new LocalPlayerDC()), "opt");
-                id++;
-                // std::cerr << argv[0] << ": invalid option != i/h\n";
-                // return EXIT_FAILURE;
-            }
-        }
-        // scenario
-#if 0
-        g.set(0, 0, PlayerId::first);
-        g.set(1, 1, PlayerId::second);
-        g.set(0, 1, PlayerId::first);
-        g.set(0, 2, PlayerId::second);
-#endif
-
-        std::cout << g.board();
-        g.run();
-    } catch (std::exception const& e) {
-        std::cerr << e.what() << '\n';
-    }
-}
-// Vim: let $CXXFLAGS='-std=c++0x -g -pedantic -Wall'
+/**
+ * @file    tictactoe.cpp
+ */
+/**\mainpage
+ * @brief Tic-Tac-Toe AI in C++11.
+ *
+ * This little program has been written as a solution to a tic-tac-toe
+ * exercise on the French C++ forum of the siteduzero.com.
+ *
+ * It implements three AI strategies:
+ * [negamax](http://en.wikipedia.org/wiki/Negamax), negamax with
+ * [alpha/beta pruning](http://en.wikipedia.org/wiki/Alpha-beta_pruning),
+ * and [negascout](http://en.wikipedia.org/wiki/Negascout). It lets the
+ * user the possibility to play against the machine, or two AIs to play
+ * against each other.
+ *
+ * @note 
+ * I took this exercise as an excuse to play with a few C++11 features:
+ * <code>enum class</code>, tuples, rvalue-references, \c
+ * std::unique_ptr<>, \em etc.
+ *
+ * @author Copyright 2011,2013 Luc Hermitte
+ * <p><b>Licence</b> GPL v3.0.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+#include <tuple>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <ostream>
+#include <iostream>
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include <random>
+#include <cmath>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+
+#include <cassert>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  define HAVE_POSIX 1
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <sys/file.h>
+#  include <sys/resource.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#else
+#  define HAVE_POSIX 0
+#endif
+
+#define DEBUG_AI_LEVEL 0
+
+/**@defgroup gPlayer Player related definitions */
+/**@defgroup gGame Game related definitions */
+
+/**@defgroup gPlayerId Player Identifier
+ *\ingroup gPlayer
+ *@{
+ */
+/// Player Id.
+enum class PlayerId {
+    first=1, second=2
+};
+/// Operator to iterate over players.
+PlayerId operator++(PlayerId &id, int) {
+    PlayerId tmp = id;
+    id=PlayerId(3-size_t(id));
+    return tmp;
+}
+/// Displays what the player uses on the board ('X', or 'O').
+std::ostream & operator<<(std::ostream & os, const PlayerId & v) {
+    const char c = (v==PlayerId::first ? 'X' : 'O');
+    return os << c;
+}
+//@}
+
+/**@defgroup gSquares Squares from the Board
+ *\ingroup gGame
+ *@{
+ */
+/** Value of a square.
+ * A square on the board may be %unoccupied, or occupied by a token of
+ * any player.
+ */
+enum class SquareValue {
+    unoccupied  =0,
+    first =int(PlayerId::first),
+    second=int(PlayerId::second)
+};
+
+/** %Square on the \c Board.
+ * This helper class holds the value of a square, and provides
+ * a conversion function to display the square content.
+ */
+struct Square {
+    /// Init constructor.
+    Square(SquareValue v = SquareValue::unoccupied) : m_value(v) {}
+    /// Value accessor.
+    SquareValue value() const { return m_value; }
+    /// Conversion function to a displayable character.
+    char as_char() const {
+        switch (m_value) {
+            case SquareValue::first: return 'X';
+            case SquareValue::second: return 'O';
+            case SquareValue::unoccupied: return ' ';
+        }
+        assert(!"Invalid value");
+    }
+private:
+    SquareValue m_value;
+};
+/// Displays the content of a square.
+std::ostream& operator<<(std::ostream& os, Square c) {
+    return os << c.as_char();
+}
+//@}
+
+/*===========================================================================*/
+/*==============================[ Coordinates ]==============================*/
+/*===========================================================================*/
+/**@defgroup gCoordinate Coordinates of Squares on the Board
+ *\ingroup gGame
+ *@{
+ */
+/** Coordinates definition.
+ * As a tuple (row x column). They are only used to talk with the
+ * users: the game and the searches use \c Move.
+ */
+typedef std::tuple<size_t, size_t>       Coords;
+/** Move, as the index of the square played.
+ * The square {l,c} of a board with \c C columns is <tt>l*C+c</tt>, see
+ * \c Board::index() and \c Board::coords().
+ */
+typedef std::uint16_t                    Move;
+/// Value of no move.
+const Move no_move = 0xFFFF;
+
+std::ostream& operator<<(std::ostream&os, Coords const& c) {
+    return os << '{' << std::get<0>(c) << ',' << std::get<1>(c) << '}';
+}
+//@}
+
+
+/*===========================================================================*/
+/*=================================[ Masks ]=================================*/
+/*===========================================================================*/
+/**@defgroup gMask Bit masks of Squares
+ * @ingroup gGame
+ * @{
+ */
+/** Set of squares, stored as a bit mask.
+ * The square {l,c} of a board with \c C columns is represented by the
+ * bit <tt>l*C+c</tt>. Several 64-bit words are used in order to support
+ * boards up to 16x16 squares.
+ */
+struct Mask
+{
+    typedef std::uint64_t word_type;
+    /// Number of bits in a word.
+    static const size_t word_bits   = 64;
+    /// Number of words in a mask.
+    static const size_t nb_words    = 4;
+    /// Maximum number of squares a mask can represent.
+    static const size_t max_squares = word_bits * nb_words;
+
+    /// Init constructor: empty mask.
+    Mask() : m_words() {}
+    /** Builds a mask where the \c n first bits are set.
+     * @pre <tt>n <= max_squares</tt>, checked with an assertion
+     */
+    static Mask first_n(size_t n) {
+        assert(n <= max_squares);
+        Mask m;
+        for (size_t w=0; w!=nb_words && n ; ++w) {
+            const size_t nb = std::min(n, word_bits);
+            m.m_words[w] = nb == word_bits ? ~word_type(0) : (word_type(1) << nb) - 1;
+            n -= nb;
+        }
+        return m;
+    }
+
+    /// Tells whether the i-th bit is set.
+    bool test(size_t i) const { return (word(i) & bit(i)) != 0; }
+    /// Sets the i-th bit.
+    void set(size_t i)        { word(i) |=  bit(i); }
+    /// Clears the i-th bit.
+    void reset(size_t i)      { word(i) &= ~bit(i); }
+
+    /// Tells whether no bit is set.
+    bool none() const {
+        word_type r = 0;
+        for (size_t w=0; w!=nb_words ; ++w) r |= m_words[w];
+        return r == 0;
+    }
+    /// Tells whether any bit is set.
+    bool any() const { return !none(); }
+    /// Number of bits set.
+    size_t count() const {
+        size_t nb = 0;
+        for (size_t w=0; w!=nb_words ; ++w) nb += pop_count(m_words[w]);
+        return nb;
+    }
+    /** Index of the lowest bit set.
+     * @pre the mask is not null, checked with an assertion
+     */
+    size_t first() const {
+        for (size_t w=0; w!=nb_words ; ++w) {
+            if (m_words[w]) return w*word_bits + lowest_bit(m_words[w]);
+        }
+        assert(!"empty mask");
+        return max_squares;
+    }
+
+    Mask& operator&=(Mask const& rhs) {
+        for (size_t w=0; w!=nb_words ; ++w) m_words[w] &= rhs.m_words[w];
+        return *this;
+    }
+    Mask& operator|=(Mask const& rhs) {
+        for (size_t w=0; w!=nb_words ; ++w) m_words[w] |= rhs.m_words[w];
+        return *this;
+    }
+    Mask& operator^=(Mask const& rhs) {
+        for (size_t w=0; w!=nb_words ; ++w) m_words[w] ^= rhs.m_words[w];
+        return *this;
+    }
+    friend Mask operator&(Mask lhs, Mask const& rhs) { return lhs &= rhs; }
+    friend Mask operator|(Mask lhs, Mask const& rhs) { return lhs |= rhs; }
+    friend Mask operator^(Mask lhs, Mask const& rhs) { return lhs ^= rhs; }
+    friend bool operator==(Mask const& lhs, Mask const& rhs) {
+        word_type r = 0;
+        for (size_t w=0; w!=nb_words ; ++w) r |= lhs.m_words[w] ^ rhs.m_words[w];
+        return r == 0;
+    }
+    friend bool operator!=(Mask const& lhs, Mask const& rhs) { return !(lhs == rhs); }
+
+    /** Iterates over the bits set, from the lowest to the highest.
+     * @param[in] f  functor called with the index of each bit set.
+     * @return as soon as \c f() returns \c false, in which case \c false
+     * is returned.
+     * @throw Whatever f may throw
+     */
+    template <class F> bool for_each_bit(F f) const {
+        for (size_t w=0; w!=nb_words ; ++w) {
+            for (word_type bits = m_words[w]; bits ; bits &= bits-1) {
+                if (!f(w*word_bits + lowest_bit(bits)))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    /// Accessor to the w-th word.
+    word_type word_at(size_t w) const { assert(w < nb_words); return m_words[w]; }
+
+    /// Index of the lowest bit set in a non null word.
+    static size_t lowest_bit(word_type v) {
+        assert(v);
+#if defined(__GNUC__)
+        return __builtin_ctzll(v);
+#else
+        size_t i = 0;
+        for ( ; !(v & 1) ; v >>= 1) ++i;
+        return i;
+#endif
+    }
+    /// Number of bits set in a word.
+    static size_t pop_count(word_type v) {
+#if defined(__GNUC__)
+        return __builtin_popcountll(v);
+#else
+        size_t nb = 0;
+        for ( ; v ; v &= v-1) ++nb;
+        return nb;
+#endif
+    }
+private:
+    static word_type bit(size_t i) { return word_type(1) << (i % word_bits); }
+    word_type      & word(size_t i)       { assert(i < max_squares); return m_words[i / word_bits]; }
+    word_type const& word(size_t i) const { assert(i < max_squares); return m_words[i / word_bits]; }
+
+    std::array<word_type, nb_words> m_words;
+};
+//@}
+
+/*===========================================================================*/
+/*=================================[ Board ]=================================*/
+/*===========================================================================*/
+/**@defgroup gBoard Board related definitions
+ * @ingroup gGame
+ * @{
+ */
+/** %Board Definition.
+ * A board is made of \c L_ x \c C_ \link Square squares\endlink.
+ *
+ * We can:
+ * - sets the value of a square
+ * - interrogates the value of a square
+ *
+ * The squares are stored as bitboards: one \c Mask per player, plus
+ * the mask of unoccupied squares.
+ */
+struct Board
+{
+    /** Init constructor.
+     * @throw std::length_error if the board has more than \c
+     * Mask::max_squares squares.
+     */
+    Board(size_t L_, size_t C_)
+        : m_L(L_), m_C(C_) { init(); }
+    /// Init constructor for square boards.
+    Board(size_t L_=3)
+        : m_L(L_), m_C(L_) { init(); }
+    // Board(Board && tmp)
+
+    /// \c Square accessor.
+    Square operator()(size_t l, size_t c) const {
+        return value(index(l,c));
+    }
+    /// \c Square accessor.
+    Square operator()(Coords c) const {
+        return value(index(c));
+    }
+
+    /// Is a \c Square unoccupied ?
+    bool is_empty(size_t l, size_t c) const {
+        return m_empty.test(index(l,c));
+    }
+    /** Occupies a \c Square with a player's move.
+     * @pre the square must be unoccupied.
+     * @pre <tt>v != SquareValue::unoccupied</tt>, checked with an assertion
+     * @post <tt>board(l,c) == v</tt>
+     * @return whether the operation has succeeded
+     */
+    bool set(size_t l, size_t c, SquareValue v) {
+        return set(index(l,c), v);
+    }
+    /** Occupies a \c Square with a player's move.
+     * @pre the square must be unoccupied.
+     * @post <tt>board(c) == v</tt>
+     * @return whether the operation has succeeded
+     */
+    bool set(Coords const& c, SquareValue v) {
+        return set(index(c), v);
+    }
+    /** Clears a \c Square.
+     * @post <tt>board(l,c) == SquareValue::unoccupied</tt>
+     */
+    void reset(size_t l, size_t c) {
+        reset(index(l,c));
+    }
+    /** Clears a \c Square.
+     * @post <tt>board(c) == SquareValue::unoccupied</tt>
+     */
+    void reset(Coords const& c) {
+        reset(index(c));
+    }
+
+    /** Occupies a \c Square, given its index, with a player's move.
+     * @pre the square must be unoccupied.
+     * @pre <tt>v != SquareValue::unoccupied</tt>, checked with an assertion
+     * @return whether the operation has succeeded
+     */
+    bool set(size_t i, SquareValue v) {
+        assert(v != SquareValue::unoccupied);
+        if (!m_empty.test(i)) {
+            return false;
+        }
+        m_empty.reset(i);
+        m_stones[size_t(v)-1].set(i);
+        return true;
+    }
+    /** Clears a \c Square, given its index.
+     * @return the previous value of the square.
+     */
+    SquareValue reset(size_t i) {
+        const SquareValue v = value(i);
+        if (v != SquareValue::unoccupied) {
+            m_stones[size_t(v)-1].reset(i);
+            m_empty.set(i);
+        }
+        return v;
+    }
+
+    /// Mask of the unoccupied squares.
+    Mask const& empty_squares() const { return m_empty; }
+    /** Mask of the squares occupied by a player.
+     * @pre <tt>v != SquareValue::unoccupied</tt>, checked with an assertion
+     */
+    Mask const& stones(SquareValue v) const {
+        assert(v != SquareValue::unoccupied);
+        return m_stones[size_t(v)-1];
+    }
+
+    /** Index of the bit associated to a \c Square in the masks.
+     * @pre <tt>l < L()</tt>, checked with an assertion
+     * @pre <tt>c < C()</tt>, checked with an assertion
+     */
+    size_t index(size_t l, size_t c) const {
+        assert(l < L());
+        assert(c < C());
+        return l*C()+c;
+    }
+    /// Index of the bit associated to a \c Square in the masks.
+    size_t index(Coords const& c) const {
+        return index(std::get<0>(c), std::get<1>(c));
+    }
+    /// Coordinates of the \c Square associated to a bit in the masks.
+    Coords coords(size_t i) const {
+        assert(i < L()*C());
+        return Coords{i / C(), i % C()};
+    }
+
+    /// Maximum number of rows of the board.
+    size_t L() const { return m_L; }
+    /// Maximum number of columns of the board.
+    size_t C() const { return m_C; }
+    /// Coordinates of the bottom-right.
+    Coords M() const { return Coords{L(), C()}; }
+private:
+    void init() {
+        if (L()*C() > Mask::max_squares) {
+            throw std::length_error("Boards are limited to "
+                    + std::to_string(Mask::max_squares) + " squares");
+        }
+        m_empty = Mask::first_n(L()*C());
+    }
+    SquareValue value(size_t i) const {
+        return m_empty.test(i)     ? SquareValue::unoccupied
+            :  m_stones[0].test(i) ? SquareValue::first
+            :                        SquareValue::second;
+    }
+
+    Mask              m_stones[2];
+    Mask              m_empty;
+    size_t            m_L;
+    size_t            m_C;
+};
+
+/// Helper function to draw an line of +-+-+-+...+.
+std::ostream & draw_line(std::ostream& os , size_t C)
+{
+    os << '+';
+    for (size_t c=0; c!=C ; ++c) 
+        os << "-+";
+    return os;
+}
+
+/// Displays a \c Board on a text stream.
+std::ostream& operator<<(std::ostream&os, Board const& b) {
+    draw_line(os, b.C());
+    for (size_t l=0; l!=b.L() ; ++l) {
+        os << "\n|";
+        for (size_t c=0; c!=b.C() ; ++c) {
+            os << b(l,c) << '|';
+        }
+        draw_line(os<<'\n', b.C());
+    }
+    return os << '\n';
+}
+//@}
+
+/*===========================================================================*/
+/*=============================[ Winning lines ]=============================*/
+/*===========================================================================*/
+/**@defgroup gLines Winning lines
+ * @ingroup gGame
+ * @{
+ */
+/** Winning lines of a board.
+ * A winning line is a window of \c K aligned squares, in any of the
+ * four directions (row, column, and the two diagonals). This table
+ * precomputes the masks of all the winning lines of a board, and for
+ * each square, the list of the lines that contain it.
+ *
+ * Thus, checking whether a move wins is reduced to a few bitwise
+ * AND/compare operations. To keep them cheap, the lines of each square
+ * are also stored as the few words of their masks that are not null.
+ */
+struct WinningLines
+{
+    /** Init constructor.
+     * @param[in] L  number of rows of the board
+     * @param[in] C  number of columns of the board
+     * @param[in] K  number of aligned tokens required to win
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    WinningLines(size_t L, size_t C, size_t K)
+        : m_L(L), m_C(C), m_K(K)
+    {
+        // {row, column} steps of the four directions
+        static const ptrdiff_t dirs[4][2] = { {0, 1}, {1, 0}, {1, 1}, {1, -1} };
+        std::vector<std::vector<size_t>> lines_of(L*C);
+        // With K==1, the four directions give the same lines
+        const size_t nb_dirs = K == 1 ? 1 : 4;
+        for (size_t d=0; d!=nb_dirs && K ; ++d) {
+            const ptrdiff_t dl = dirs[d][0];
+            const ptrdiff_t dc = dirs[d][1];
+            for (size_t l=0; l!=L ; ++l) {
+                for (size_t c=0; c!=C ; ++c) {
+                    const ptrdiff_t last_l = ptrdiff_t(l) + dl*ptrdiff_t(K-1);
+                    const ptrdiff_t last_c = ptrdiff_t(c) + dc*ptrdiff_t(K-1);
+                    if (last_l < 0 || last_l >= ptrdiff_t(L) || last_c < 0 || last_c >= ptrdiff_t(C))
+                        continue;
+                    Mask line;
+                    for (size_t k=0; k!=K ; ++k) {
+                        const size_t i = (l+k*dl)*C + size_t(ptrdiff_t(c)+ptrdiff_t(k)*dc);
+                        line.set(i);
+                        lines_of[i].push_back(m_lines.size());
+                    }
+                    m_lines.push_back(line);
+                    m_spans.push_back(Span{std::uint16_t(l*C+c), std::uint16_t(ptrdiff_t(C)*dl+dc)});
+                }
+            }
+        }
+        m_offsets.reserve(L*C+1);
+        m_offsets.push_back(0);
+        m_part_offsets.reserve(L*C+1);
+        m_part_offsets.push_back(0);
+        for (auto const& ids : lines_of) {
+            m_ids.insert(m_ids.end(), ids.begin(), ids.end());
+            m_offsets.push_back(m_ids.size());
+            for (size_t id : ids) {
+                Mask const& line = m_lines[id];
+                for (size_t w=0; w!=Mask::nb_words ; ++w) {
+                    if (line.word_at(w)) {
+                        m_parts.push_back(Part{line.word_at(w), std::uint32_t(w), false});
+                    }
+                }
+                m_parts.back().last = true;
+            }
+            m_part_offsets.push_back(m_parts.size());
+        }
+        m_contents.resize((K+1)*(K+1));
+        for (size_t n0=0; n0<=K ; ++n0) {
+            for (size_t n1=0; n1<=K ; ++n1) {
+                Content & content = m_contents[n0 + n1*(K+1)];
+                content.value
+                    = n1 == 0 && n0 ? +(1 << 2*std::min<size_t>(n0-1, 5))
+                    : n0 == 0 && n1 ? -(1 << 2*std::min<size_t>(n1-1, 5))
+                    : 0;
+                // With K==1, any free square wins: there is no need to
+                // track them
+                content.threat
+                    = K < 2                 ? SquareValue::unoccupied
+                    : n0 == K-1 && n1 == 0  ? SquareValue::first
+                    : n1 == K-1 && n0 == 0  ? SquareValue::second
+                    :                         SquareValue::unoccupied;
+            }
+        }
+    }
+
+    /** Tells whether a square completes a line.
+     * @param[in] i  index of the square, see \c Board::index()
+     * @param[in] stones  tokens of the player, including the one at \c i
+     * @throw None.
+     */
+    bool completes_a_line(size_t i, Mask const& stones) const {
+        assert(i+1 < m_part_offsets.size());
+        bool complete = true;
+        for (size_t k=m_part_offsets[i], e=m_part_offsets[i+1]; k!=e ; ++k) {
+            Part const& part = m_parts[k];
+            complete = complete && (stones.word_at(part.word) & part.bits) == part.bits;
+            if (part.last) {
+                if (complete) return true;
+                complete = true;
+            }
+        }
+        return false;
+    }
+
+    /// Number of winning lines.
+    size_t size() const { return m_lines.size(); }
+    /// Mask of a winning line.
+    Mask const& line(size_t id) const { return m_lines[id]; }
+    /** Iterates over the ids of the lines that contain a square.
+     * @return as soon as \c f() returns \c false.
+     */
+    template <class F> void for_each_line_of(size_t i, F f) const {
+        for (size_t k=m_offsets[i], e=m_offsets[i+1]; k!=e && f(m_ids[k]) ; ++k) {
+        }
+    }
+
+    /** Value of a line, for the first player.
+     * A line open to a single player is worth 1, 4, 16, ... (capped to
+     * 1024) as it contains 1, 2, 3, ... tokens of this player. Blocked
+     * and empty lines are worth nothing.
+     * @param[in] content  number of tokens of the first player, plus
+     * the number of tokens of the second player times \c content_step()
+     * @throw None
+     */
+    int value(size_t content) const {
+        assert(content < m_contents.size());
+        return m_contents[content].value;
+    }
+    /** Player threatening to complete a line.
+     * @param[in] content  content of the line, see \c value()
+     * @return the player who has all the tokens of the line but one,
+     * the other square being free; \c SquareValue::unoccupied otherwise.
+     * @throw None
+     */
+    SquareValue threat(size_t content) const {
+        assert(content < m_contents.size());
+        return m_contents[content].threat;
+    }
+    /// Increment of a line content when a token of \c v is played.
+    size_t content_step(SquareValue v) const {
+        return v == SquareValue::first ? 1 : m_K+1;
+    }
+
+    /** Free square of a line.
+     * @param[in] id  line
+     * @param[in] owned  tokens on the board
+     * @param[in] ignored  square considered as owned
+     * @return the first square of the line that is neither in \c owned
+     * nor \c ignored.
+     * @pre there is such a square, checked with an assertion
+     */
+    size_t first_free(size_t id, Mask const& owned, size_t ignored) const {
+        Span const& span = m_spans[id];
+        size_t i = span.first;
+        for (size_t k=0; k!=m_K ; ++k, i+=span.step) {
+            if (i != ignored && !owned.test(i)) return i;
+        }
+        assert(!"no free square");
+        return i;
+    }
+
+    /// Tells whether the table applies to a board of L x C, with K aligned tokens.
+    bool match(size_t L, size_t C, size_t K) const {
+        return L == m_L && C == m_C && K == m_K;
+    }
+private:
+    /// Non null word of the mask of a line.
+    struct Part {
+        Mask::word_type bits;
+        std::uint32_t   word;
+        bool            last; ///< last part of the line
+    };
+
+    /// First square of a line, and distance to the next square.
+    struct Span {
+        std::uint16_t first;
+        std::uint16_t step;
+    };
+
+    std::vector<Mask>   m_lines;
+    std::vector<Span>   m_spans;        ///< squares of each line
+    std::vector<size_t> m_ids;          ///< lines of each square
+    std::vector<size_t> m_offsets;      ///< ranges of \c m_ids, per square
+    std::vector<Part>   m_parts;        ///< lines of each square, as parts
+    std::vector<size_t> m_part_offsets; ///< ranges of \c m_parts, per square
+    /// Properties of a line, depending on its content.
+    struct Content {
+        int         value;
+        SquareValue threat;
+    };
+
+    std::vector<Content> m_contents;    ///< per content
+    size_t              m_L;
+    size_t              m_C;
+    size_t              m_K;
+};
+//@}
+
+/*===========================================================================*/
+/*============================[ Neighbourhoods ]=============================*/
+/*===========================================================================*/
+/**@defgroup gNeighbourhoods Neighbourhoods of squares
+ * @ingroup gGame
+ * @{
+ */
+/** Neighbourhoods of the squares of a board.
+ * The neighbourhood of radius \c R of a square is made of the other
+ * squares at most \c R rows and \c R columns away. Moves far from all
+ * the tokens on the board seldom matter: searches only consider the
+ * squares in the neighbourhood of a token, see \c
+ * GameState::candidate_moves().
+ */
+struct Neighbourhoods
+{
+    /** Init constructor.
+     * @param[in] L  number of rows of the board
+     * @param[in] C  number of columns of the board
+     * @param[in] R  radius of the neighbourhoods, 0 for none
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    Neighbourhoods(size_t L, size_t C, size_t R)
+        : m_masks(L*C), m_L(L), m_C(C), m_R(R)
+    {
+        for (size_t l=0; l!=L && R ; ++l) {
+            for (size_t c=0; c!=C ; ++c) {
+                Mask & m = m_masks[l*C+c];
+                for (size_t nl=l-std::min(l,R); nl<=std::min(l+R, L-1) ; ++nl) {
+                    for (size_t nc=c-std::min(c,R); nc<=std::min(c+R, C-1) ; ++nc) {
+                        m.set(nl*C+nc);
+                    }
+                }
+                m.reset(l*C+c);
+            }
+        }
+    }
+
+    /** Neighbourhood of a square.
+     * @param[in] i  index of the square, see \c Board::index()
+     */
+    Mask const& operator()(size_t i) const {
+        assert(i < m_masks.size());
+        return m_masks[i];
+    }
+    /** Union of the neighbourhoods of a set of squares.
+     * @throw None
+     */
+    Mask operator()(Mask const& squares) const {
+        Mask res;
+        squares.for_each_bit([&](size_t i) -> bool {
+                res = res | m_masks[i];
+                return true;
+            });
+        return res;
+    }
+
+    /// Radius of the neighbourhoods.
+    size_t radius() const { return m_R; }
+    /// Tells whether the table applies to a board of L x C, with radius R.
+    bool match(size_t L, size_t C, size_t R) const {
+        return L == m_L && C == m_C && R == m_R;
+    }
+private:
+    std::vector<Mask> m_masks; ///< neighbourhood of each square
+    size_t            m_L;
+    size_t            m_C;
+    size_t            m_R;
+};
+//@}
+
+/*===========================================================================*/
+/*============================[ Zobrist hashing ]============================*/
+/*===========================================================================*/
+/**@defgroup gHash Position hashing
+ * @ingroup gGame
+ * @{
+ */
+/** Zobrist keys.
+ * A random 64-bit key is associated to every pair (square, player). The
+ * hash of a position is the xor of the keys of all the tokens on the
+ * board; it is thus updated incrementally each time a token is played
+ * or removed.
+ * @note The player to move is not hashed as it is deduced from the
+ * number of tokens on the board.
+ */
+struct ZobristKeys
+{
+    /// Init constructor: keys are drawn from a fixed seed.
+    ZobristKeys() {
+        std::mt19937_64 gen(0x7c7ac70e);
+        for (auto & player_keys : m_keys)
+            for (auto & k : player_keys)
+                k = gen();
+    }
+    /** Key of a token.
+     * @param[in] i  index of the square, see \c Board::index()
+     * @param[in] v  player owning the token
+     * @pre <tt>v != SquareValue::unoccupied</tt>, checked with an assertion
+     */
+    std::uint64_t operator()(size_t i, SquareValue v) const {
+        assert(v != SquareValue::unoccupied);
+        assert(i < Mask::max_squares);
+        return m_keys[size_t(v)-1][i];
+    }
+private:
+    std::array<std::array<std::uint64_t, Mask::max_squares>, 2> m_keys;
+};
+
+/// Zobrist keys shared by all games.
+const ZobristKeys zobrist;
+//@}
+
+/*===========================================================================*/
+/*==============================[ Symmetries ]===============================*/
+/*===========================================================================*/
+/**@defgroup gSymmetries Board symmetries
+ * @ingroup gGame
+ * @{
+ */
+/** Symmetries of a board.
+ * Rectangular boards are invariant by 4 symmetries: identity, the two
+ * reflections along the middle row and the middle column, and the half
+ * turn. Square boards are also invariant by the two reflections along
+ * the diagonals, and the two quarter turns.
+ *
+ * Positions that are images of each other by a symmetry are
+ * equivalent, and so are the moves from a position to the images of the
+ * position by the symmetries that leave it unchanged. In order to
+ * recognise them cheaply, this table stores for each symmetry the image
+ * of every square, and the Zobrist keys of the images of every token.
+ */
+struct Symmetries
+{
+    /// Maximal number of symmetries of a board.
+    static const size_t max_symmetries = 8;
+
+    /** Init constructor.
+     * @param[in] L  number of rows of the board
+     * @param[in] C  number of columns of the board
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    Symmetries(size_t L, size_t C)
+        : m_L(L), m_C(C), m_size(L == C ? 8 : 4)
+        , m_images(m_size * L*C)
+        , m_preimages(m_size * L*C)
+        , m_keys(2 * max_symmetries * L*C)
+    {
+        for (size_t l=0; l!=L ; ++l) {
+            for (size_t c=0; c!=C ; ++c) {
+                const size_t images[max_symmetries] = {
+                    l*C + c,                 // identity
+                    (L-1-l)*C + c,           // reflection along the middle row
+                    l*C + (C-1-c),           // reflection along the middle column
+                    (L-1-l)*C + (C-1-c),     // half turn
+                    // square boards only
+                    c*C + l,                 // reflection along the main diagonal
+                    c*C + (L-1-l),           // quarter turn
+                    (C-1-c)*C + l,           // three quarter turn
+                    (C-1-c)*C + (L-1-l),     // reflection along the other diagonal
+                };
+                const size_t i = l*C + c;
+                for (size_t s=0; s!=m_size ; ++s) {
+                    m_images[s*L*C + i] = std::uint16_t(images[s]);
+                    m_preimages[s*L*C + images[s]] = std::uint16_t(i);
+                }
+            }
+        }
+        for (size_t i=0; i!=L*C ; ++i) {
+            for (SquareValue v : {SquareValue::first, SquareValue::second}) {
+                for (size_t s=0; s!=m_size ; ++s) {
+                    m_keys[key_index(i, v) + s] = zobrist(image(s, i), v);
+                }
+            }
+        }
+    }
+
+    /// Number of symmetries of the board.
+    size_t size() const { return m_size; }
+    /// Image of the square \c i by the symmetry \c s.
+    size_t image(size_t s, size_t i) const {
+        assert(s < m_size && i < m_L*m_C);
+        return m_images[s*m_L*m_C + i];
+    }
+    /// Square whose image by the symmetry \c s is \c i.
+    size_t preimage(size_t s, size_t i) const {
+        assert(s < m_size && i < m_L*m_C);
+        return m_preimages[s*m_L*m_C + i];
+    }
+    /** Zobrist keys of the images of a token, by every symmetry.
+     * @return an array of \c size() keys
+     */
+    std::uint64_t const* keys(size_t i, SquareValue v) const {
+        return &m_keys[key_index(i, v)];
+    }
+    /// Image of a mask by the symmetry \c s.
+    Mask image(size_t s, Mask const& m) const {
+        Mask res;
+        m.for_each_bit([&](size_t i) -> bool {
+                res.set(this->image(s, i));
+                return true;
+            });
+        return res;
+    }
+
+    /// Tells whether the table applies to a board of L x C.
+    bool match(size_t L, size_t C) const {
+        return L == m_L && C == m_C;
+    }
+private:
+    size_t key_index(size_t i, SquareValue v) const {
+        return (i*2 + size_t(v)-size_t(SquareValue::first)) * max_symmetries;
+    }
+
+    size_t                     m_L;
+    size_t                     m_C;
+    size_t                     m_size;
+    std::vector<std::uint16_t> m_images;    ///< per symmetry, then per square
+    std::vector<std::uint16_t> m_preimages; ///< per symmetry, then per square
+    std::vector<std::uint64_t> m_keys;      ///< per square, player, then symmetry
+};
+//@}
+
+/*===========================================================================*/
+/*========================[ Player Decision Centres ]========================*/
+/*===========================================================================*/
+struct Game;
+
+/**@addtogroup gPlayer
+ *@{
+ */
+/**@defgroup gPlayerAI Player AI */
+/**@ingroup gPlayerAI
+ * Interface class for Player Decision Centres.
+ * Human players, and AI players all share the same interface when
+ * considering their decisions: they are asked what move they \c choose
+ * to perform.
+ * @note non copyable.
+ */
+struct PlayerDC
+{
+    virtual ~PlayerDC() {};
+    /**
+     * Chooses the next move.
+     * This function is to be specialized depending on the actual kind
+     * of player (humain, or various AI algorithms). This is where the
+     * actual decision will be made
+     * @param[in,out] g  Game current state. 
+     * @return Next move chosen
+     */
+    virtual Move choose(Game & g) const = 0;
+
+    /** Thinks during the turn of the adversary.
+     * Called once the player has played, with the game where her
+     * adversary is to move. It shall return at once: the thinking goes
+     * on in the background, till the next \c choose(), or \c
+     * stop_pondering(). By default, nothing is done.
+     * @param[in] g  Game current state.
+     */
+    virtual void ponder(Game const&) const {}
+    /// Stops the thinking started by \c ponder(), if any.
+    virtual void stop_pondering() const {}
+
+protected:
+    PlayerDC() {}
+    PlayerDC           (PlayerDC const&) = delete;
+    PlayerDC& operator=(PlayerDC const&) = delete;
+};
+
+/** Actual player class.
+ * The \em strategy Design Pattern is implemented regarding how players
+ * decide of their next move.
+ */
+struct Player
+{
+    /**
+     * %Player init constructor.
+     * @param[in] dc_  Decision centre for the player. 
+     * @param[in] name_  Name of the new player.
+     *
+     * @pre \c dc_ is not null, checked with an assertion
+     * @note \c dc_ responsibility is moved to the new \c Player
+     * instance.
+     */
+    Player(std::unique_ptr<PlayerDC>&& dc_, std::string && name_)
+        : m_dc(std::move(dc_))
+        , m_name(name_)
+        {
+            assert(m_dc);
+        }
+    /** Choose the next move.
+     * The actual choice is given to the exact \link PlayerDC decision
+     * centre\endlink instantiated.
+     * @param[in,out] g  Game current state. 
+     * @return Next move chosen
+     * @see \c PlayerDC::choose()
+     */
+    Move choose(Game & g) const { return m_dc->choose(g); }
+    /// @see \c PlayerDC::ponder()
+    void ponder(Game const& g) const { m_dc->ponder(g); }
+    /// @see \c PlayerDC::stop_pondering()
+    void stop_pondering() const { m_dc->stop_pondering(); }
+    /// Name accessor.
+    std::string const& name() const { return m_name; }
+private:
+    std::unique_ptr<PlayerDC> m_dc;
+    std::string               m_name;
+};
+
+/// Displays a player's name.
+std::ostream & operator<<(std::ostream & os, const Player & v) {
+    return os << v.name();
+}
+//@}
+
+
+/*===========================================================================*/
+/*=================================[ Game ]==================================*/
+/*===========================================================================*/
+/**@addtogroup gGame
+ *@{
+ */
+/** Geometry of the board, known at run time.
+ * Geometries tell \c GameState how the board is laid out in its hot
+ * paths: playing a move, and checking whether a move wins. See \c
+ * FixedGeometry for the same geometry known at compile time.
+ */
+struct DynamicGeometry
+{
+    /// Init constructor.
+    DynamicGeometry(size_t L_, size_t C_, size_t K_, WinningLines const& lines, size_t nb_symmetries_)
+        : m_L(L_), m_C(C_), m_K(K_), m_lines(lines), m_nb_symmetries(nb_symmetries_) {}
+    size_t L() const { return m_L; }
+    size_t C() const { return m_C; }
+    /// Number of tokens in a row required to win.
+    size_t K() const { return m_K; }
+    /// Number of symmetries of the board.
+    size_t nb_symmetries() const { return m_nb_symmetries; }
+    /// Tells whether the square \c i completes a line of \c stones.
+    bool completes_a_line(size_t i, Mask const& stones) const {
+        return m_lines.completes_a_line(i, stones);
+    }
+private:
+    const size_t        m_L;
+    const size_t        m_C;
+    const size_t        m_K;
+    WinningLines const& m_lines;
+    const size_t        m_nb_symmetries;
+};
+
+/** Geometry of the board, known at compile time.
+ * The index computations are made with constants, and the win checks
+ * are unrolled: they count the tokens aligned with the square played,
+ * in each direction, instead of going through the \c WinningLines.
+ * @tparam L_  number of rows
+ * @tparam C_  number of columns
+ * @tparam K_  number of tokens in a row required to win
+ */
+template <size_t L_, size_t C_, size_t K_> struct FixedGeometry
+{
+    static_assert(L_*C_ <= Mask::max_squares, "Board too big for the masks");
+    static_assert(K_ >= 1 && K_ <= L_ && K_ <= C_, "Lines do not fit in the board");
+
+    static constexpr size_t L() { return L_; }
+    static constexpr size_t C() { return C_; }
+    static constexpr size_t K() { return K_; }
+    static constexpr size_t nb_symmetries() { return L_ == C_ ? 8 : 4; }
+    static bool completes_a_line(size_t i, Mask const& stones) {
+        const size_t l = i / C_;
+        const size_t c = i % C_;
+        return aligned<0, 1>(stones, l, c) + aligned<0, -1>(stones, l, c) >= K_-1
+            || aligned<1, 0>(stones, l, c) + aligned<-1, 0>(stones, l, c) >= K_-1
+            || aligned<1, 1>(stones, l, c) + aligned<-1,-1>(stones, l, c) >= K_-1
+            || aligned<1,-1>(stones, l, c) + aligned<-1, 1>(stones, l, c) >= K_-1;
+    }
+private:
+    /// Number of \c stones that follow {l,c} in a direction, up to K-1.
+    template <int DL, int DC> static size_t aligned(Mask const& stones, size_t l, size_t c) {
+        size_t n = 0;
+        for (size_t k = 1; k != K_ ; ++k) {
+            const size_t l2 = l + DL*ptrdiff_t(k);
+            const size_t c2 = c + DC*ptrdiff_t(k);
+            // Negative coordinates wrap around, and are out of range too
+            if (l2 >= L_ || c2 >= C_ || !stones.test(l2*C_ + c2)) {
+                break;
+            }
+            ++n;
+        }
+        return n;
+    }
+};
+
+/** %Game state.
+ * This class aggregates all data about the current state of a game:
+ * - the state of the \c Board,
+ * - the current number of moves accomplished,
+ * - the number of aligned player tokens required to declare a win.
+ *
+ * Unlike \c Game, game states can be copied; e.g. to be searched by
+ * several threads.
+ */
+struct GameState
+{
+    /// Init constructor.
+    GameState(size_t L_=3, size_t C_=0, size_t nb_required_to_win = 0)
+        : m_nb_moves(0)
+        , m_board(L_, C_?C_:L_)
+        , m_nb_required_to_win(nb_required_to_win ? nb_required_to_win : L_)
+        , m_lines(std::make_shared<WinningLines>(m_board.L(), m_board.C(), m_nb_required_to_win))
+        , m_symmetries(std::make_shared<Symmetries>(m_board.L(), m_board.C()))
+        , m_neighbourhoods(std::make_shared<Neighbourhoods>(m_board.L(), m_board.C(), default_candidate_radius))
+        , m_line_contents(m_lines->size())
+        , m_score(0)
+        , m_threat_counts(m_board.L()*m_board.C())
+        {
+            m_hashes.fill(0);
+        }
+
+    /// Checks whether the \c Square at coordinates {l,c} is unoccupied.
+    bool can_play_at(size_t l, size_t c) const {
+        return m_board.is_empty(l,c);
+    }
+    /// Assigns a \c Square with a player token. 
+    bool set(Move m, PlayerId p) {
+        return set_in(geometry(), m, p);
+    }
+    /// Empties a \c Square of any a player token. 
+    void reset(Move m) {
+        reset_in(geometry(), m);
+    }
+
+    /** Iterates over all possible moves, and applies a functor on the
+     *  game state.
+     * This is a special \c for_each that iterates over possible moves
+     * from current game state.
+     * @param[in] f  functor to apply on new game states built from each
+     * possible moves.
+     * @throw Whatever f may throw
+     * @return as soon as \c f() returns \c true.
+     */
+    template <class F> void for_each_possible_move(F f) {
+        // Iterate over a copy as f() plays on the board
+        const Mask moves = candidate_moves();
+        moves.for_each_bit([&](size_t i) -> bool {
+                return f(Move(i));
+            });
+    }
+
+    /** Moves worth searching.
+     * They are the free squares in the neighbourhood of a token, or all
+     * the free squares if there is none, see \c candidate_radius().
+     * @throw None
+     */
+    Mask candidate_moves() const {
+        if (!candidate_radius()) {
+            return m_board.empty_squares();
+        }
+        const Mask occupied = m_board.stones(SquareValue::first) | m_board.stones(SquareValue::second);
+        const Mask moves = (*m_neighbourhoods)(occupied) & m_board.empty_squares();
+        return moves.any() ? moves : m_board.empty_squares();
+    }
+    /// Radius of the neighbourhoods of the tokens where moves are searched.
+    size_t candidate_radius() const { return m_neighbourhoods->radius(); }
+    /** Sets the radius of the neighbourhoods where moves are searched.
+     * @param[in] radius  radius, 0 to search all the free squares
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    void set_candidate_radius(size_t radius) {
+        m_neighbourhoods = std::make_shared<Neighbourhoods>(L(), C(), radius);
+        refresh();
+    }
+    /// Default radius of the neighbourhoods where moves are searched.
+    static const size_t default_candidate_radius = 2;
+
+    /// Number of tokens in a row required to win.
+    size_t nb_required_to_win() const { return m_nb_required_to_win; }
+    /** Sets the number of tokens in a row required to win.
+     * @param[in] k  number of tokens, 0 for the number of rows
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    void set_nb_required_to_win(size_t k) {
+        m_nb_required_to_win = k ? k : L();
+        refresh();
+    }
+
+    /** Checks whether a given move is a winning move.
+     * @param[in] m  square where a new player token shall be evaluated
+     * @param[in] p  id of the player to consider playing
+     * @return whether player \c p wins if she plays at \c m.
+     * @throw None
+     */
+    bool is_a_winning_move_for(Move m, PlayerId p) const {
+        return is_a_winning_move_in(geometry(), m, p);
+    }
+
+    /// Internal Board accessor.
+    Board const& board() const { return m_board; }
+    /// Accessor to the number of rows in the board.
+    size_t       L()     const { return m_board.L(); }
+    /// Accessor to the number of columns in the board.
+    size_t       C()     const { return m_board.C(); }
+    /// Accessor to the dimension of the board.
+    Coords       M()     const { return m_board.M(); }
+    /// Zobrist hash of the current position.
+    std::uint64_t hash() const { return m_hashes[0]; }
+    /// Zobrist hash of the image of the current position by the symmetry \c s.
+    std::uint64_t hash(size_t s) const { return m_hashes[s]; }
+    /// Symmetries of the board.
+    Symmetries const& symmetries() const { return *m_symmetries; }
+    /** Symmetry that gives the canonical form of the position.
+     * The canonical form is the image with the lowest hash; it is the
+     * same for all the equivalent positions.
+     */
+    size_t canonical_symmetry() const {
+        size_t res = 0;
+        for (size_t s=1, n=m_symmetries->size(); s!=n ; ++s) {
+            if (m_hashes[s] < m_hashes[res]) res = s;
+        }
+        return res;
+    }
+    /** Symmetries that leave the position unchanged.
+     * @return a bit mask of the symmetries, identity excluded.
+     * @throw None
+     */
+    unsigned stabilizer() const {
+        unsigned res = 0;
+        for (size_t s=1, n=m_symmetries->size(); s!=n ; ++s) {
+            // Hashes filter the candidates, masks are compared to be sure
+            if (m_hashes[s] == m_hashes[0]
+                    && m_symmetries->image(s, m_board.stones(SquareValue::first)) == m_board.stones(SquareValue::first)
+                    && m_symmetries->image(s, m_board.stones(SquareValue::second)) == m_board.stones(SquareValue::second)) {
+                res |= 1u << s;
+            }
+        }
+        return res;
+    }
+    /** Hash of the canonical form of the position after a move.
+     * It is \c hash(canonical_symmetry()) once the move is played, but
+     * the move is not played.
+     * @param[in] i  index of the free square played
+     * @param[in] p  player who plays
+     * @throw None
+     */
+    std::uint64_t canonical_hash_after(size_t i, PlayerId p) const {
+        std::uint64_t const* keys = m_symmetries->keys(i, SquareValue(size_t(p)));
+        std::uint64_t res = m_hashes[0] ^ keys[0];
+        for (size_t s=1, n=m_symmetries->size(); s!=n ; ++s) {
+            res = std::min(res, m_hashes[s] ^ keys[s]);
+        }
+        return res;
+    }
+    /** Tells whether a move is the representative of its equivalent moves.
+     * Moves are equivalent when the symmetries that leave the position
+     * unchanged transform one into the other; the representative is the
+     * one on the square of lowest index.
+     * @param[in] i  index of the square played
+     * @param[in] stabilizer  result of \c stabilizer()
+     * @throw None
+     */
+    bool is_canonical_move(size_t i, unsigned stabilizer) const {
+        for (size_t s=1; stabilizer ; ++s, stabilizer >>= 1) {
+            if ((stabilizer & 2) && m_symmetries->image(s, i) < i) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Player who has completed a line, if any.
+     * Unlike \c is_a_winning_move_for(), the whole board is checked.
+     * @return \c SquareValue::unoccupied when no line is complete.
+     * @throw None
+     */
+    SquareValue winner() const {
+        WinningLines const& lines = *m_lines;
+        for (SquareValue v : {SquareValue::first, SquareValue::second}) {
+            Mask const& stones = m_board.stones(v);
+            for (size_t id = 0, n = lines.size(); id != n ; ++id) {
+                if ((lines.line(id) & stones) == lines.line(id)) {
+                    return v;
+                }
+            }
+        }
+        return SquareValue::unoccupied;
+    }
+
+    /** Squares where a player would complete a line.
+     * They are maintained incrementally by \c set() and \c reset().
+     * @throw None
+     */
+    Mask const& threats(PlayerId p) const {
+        return m_threats[size_t(p)-1];
+    }
+
+    /** Number of threats a move would make at most.
+     * They are the lines through the square that hold all the tokens
+     * required but one once the move is played, and none of the
+     * adversary.
+     * @param[in] i  index of a free square
+     * @param[in] p  player who would play
+     * @throw None
+     */
+    size_t nb_threats_made_by(size_t i, PlayerId p) const {
+        WinningLines const& lines = *m_lines;
+        const SquareValue v    = SquareValue(size_t(p));
+        const size_t      step = lines.content_step(v);
+        size_t res = 0;
+        lines.for_each_line_of(i, [&](size_t id) -> bool {
+                res += lines.threat(m_line_contents[id] + step) == v;
+                return true;
+            });
+        return res;
+    }
+
+    /** Static evaluation of the position.
+     * Each winning line still open, i.e. occupied by the tokens of only
+     * one player, is worth 4 times more with each of these tokens.
+     * Blocked lines are worth nothing. The score is maintained
+     * incrementally by \c set() and \c reset().
+     * @param[in] p  player from whose point of view the position is
+     * evaluated
+     * @return a score in [-max_evaluation, +max_evaluation].
+     * @throw None
+     */
+    int evaluate(PlayerId p) const {
+        const int score = std::max(-max_evaluation, std::min(m_score, +max_evaluation));
+        return p == PlayerId::first ? score : -score;
+    }
+    /// Bound of static evaluations; far from win/loss scores (±1000).
+    static const int max_evaluation = 500;
+private:
+    /** Recomputes the data derived from the board.
+     * To be called each time the board is replaced.
+     */
+    void refresh() {
+        if (!m_lines->match(L(), C(), m_nb_required_to_win)) {
+            m_lines = std::make_shared<WinningLines>(L(), C(), m_nb_required_to_win);
+        }
+        if (!m_symmetries->match(L(), C())) {
+            m_symmetries = std::make_shared<Symmetries>(L(), C());
+        }
+        if (!m_neighbourhoods->match(L(), C(), candidate_radius())) {
+            m_neighbourhoods = std::make_shared<Neighbourhoods>(L(), C(), candidate_radius());
+        }
+        m_hashes.fill(0);
+        m_line_contents.assign(m_lines->size(), 0);
+        m_score = 0;
+        m_threat_counts.assign(L()*C(), ThreatCount{{0, 0}});
+        m_threats.fill(Mask());
+        // Tokens are played again, as the updates depend on the board
+        const Board board = m_board;
+        m_board = Board(L(), C());
+        for (SquareValue v : {SquareValue::first, SquareValue::second}) {
+            board.stones(v).for_each_bit([&](size_t i) -> bool {
+                    m_board.set(i, v);
+                    update_hashes(i, v);
+                    update_lines(i, v, +1);
+                    return true;
+                });
+        }
+    }
+
+    /// Updates the hashes of the position and of its images.
+    void update_hashes(size_t i, SquareValue v) {
+        update_hashes(geometry(), i, v);
+    }
+    template <class G> void update_hashes(G const& geo, size_t i, SquareValue v) {
+        std::uint64_t const* keys = m_symmetries->keys(i, v);
+        for (size_t s=0, n=geo.nb_symmetries(); s!=n ; ++s) {
+            m_hashes[s] ^= keys[s];
+        }
+    }
+
+    /** Updates the token counts of the lines through a square.
+     * @param[in] i      index of the square
+     * @param[in] v      token played/removed
+     * @param[in] delta  +1 when played, -1 when removed
+     * @throw None
+     */
+    void update_lines(size_t i, SquareValue v, int delta) {
+        update_lines(geometry(), i, v, delta);
+    }
+    template <class G> void update_lines(G const& geo, size_t i, SquareValue v, int delta) {
+        WinningLines const& lines = *m_lines;
+        const int step = delta * int(v == SquareValue::first ? 1 : geo.K()+1);
+        int score = m_score;
+        lines.for_each_line_of(i, [&](size_t id) -> bool {
+                const size_t before = m_line_contents[id];
+                const size_t after  = before + step;
+                m_line_contents[id] = std::uint16_t(after);
+                score += lines.value(after) - lines.value(before);
+                if (lines.threat(before) != lines.threat(after)) {
+                    if (lines.threat(before) != SquareValue::unoccupied)
+                        update_threat(id, lines.threat(before), i, v, delta, -1);
+                    if (lines.threat(after) != SquareValue::unoccupied)
+                        update_threat(id, lines.threat(after), i, v, delta, +1);
+                }
+                return true;
+            });
+        m_score = score;
+    }
+
+    /** Updates the threats of a player, when a line changes.
+     * @param[in] id  line that changes
+     * @param[in] p  player that threatens/threatened to complete the line
+     * @param[in] i, v, delta  change of the line, see \c update_lines();
+     * the board is already up-to-date
+     * @param[in] count  +1 if the line becomes a threat, -1 if it stops
+     * being one
+     * @throw None
+     */
+    void update_threat(size_t id, SquareValue p, size_t i, SquareValue v, int delta, int count) {
+        // Free square of the line when it is a threat: the one played
+        // or emptied, except when p plays the last but one token or
+        // removes one from a threat
+        const size_t free
+            = v != p || (delta > 0 && count < 0) ? i
+            : m_lines->first_free(id, m_board.stones(p), count < 0 ? i : Mask::max_squares);
+        const size_t k = size_t(p) - size_t(SquareValue::first);
+        std::uint8_t & n = m_threat_counts[free][k];
+        if (count > 0) {
+            if (n++ == 0) m_threats[k].set(free);
+        } else {
+            if (--n == 0) m_threats[k].reset(free);
+        }
+    }
+
+protected:
+    /**@name Hot paths, for any geometry
+     * @see \c FixedGameState
+     */
+    //@{
+    /// Geometry of the board.
+    DynamicGeometry geometry() const {
+        return DynamicGeometry(L(), C(), m_nb_required_to_win, *m_lines, m_symmetries->size());
+    }
+    template <class G> bool set_in(G const& geo, Move i, PlayerId p) {
+        const SquareValue v = SquareValue(size_t(p));
+        if (!m_board.set(i,v)) {
+            return false;
+        }
+        update_hashes(geo, i, v);
+        update_lines(geo, i, v, +1);
+        return true;
+    }
+    template <class G> void reset_in(G const& geo, Move i) {
+        const SquareValue v = m_board.reset(i);
+        if (v != SquareValue::unoccupied) {
+            update_hashes(geo, i, v);
+            update_lines(geo, i, v, -1);
+        }
+    }
+    template <class G> bool is_a_winning_move_in(G const& geo, Move i, PlayerId p) const {
+        Mask stones = m_board.stones(SquareValue(size_t(p)));
+        stones.set(i); // in case the token is not played yet
+        return geo.completes_a_line(i, stones);
+    }
+    //@}
+
+    /**@name Game dynamic data
+     * Data that define the current state of the game.
+     * They evolve during the game.
+     */
+    //@{
+    size_t              m_nb_moves;
+private:
+    Board               m_board;
+    /// Hashes of the images of the position, by each symmetry.
+    std::array<std::uint64_t, Symmetries::max_symmetries> m_hashes;
+    //@}
+    /**@name Game static data */
+    //@{
+    size_t              m_nb_required_to_win;
+    /// Shared by the copies of the state.
+    std::shared_ptr<const WinningLines> m_lines;
+    /// Shared by the copies of the state.
+    std::shared_ptr<const Symmetries>   m_symmetries;
+    /// Shared by the copies of the state.
+    std::shared_ptr<const Neighbourhoods> m_neighbourhoods;
+    //@}
+    /**@name Static evaluation data */
+    //@{
+    /// Content of each winning line, see \c WinningLines::value().
+    std::vector<std::uint16_t> m_line_contents;
+    /// Sum of the values of all lines, for the first player.
+    int                 m_score;
+    /// Number of lines each player threatens to complete, per square.
+    typedef std::array<std::uint8_t, 2> ThreatCount;
+    std::vector<ThreatCount> m_threat_counts;
+    /// Squares where each player would complete a line.
+    std::array<Mask, 2> m_threats;
+    //@}
+
+    friend std::istream & operator>>(std::istream & is,  GameState & v);
+};
+
+/** %Game state of a board whose geometry is known at compile time.
+ * It is a \c GameState, whose hot paths are specialised for the
+ * geometry: the searches templated on the state run them instead of the
+ * generic ones, see \c AIPlayerDC::with_fixed_geometry().
+ * @tparam L_  number of rows
+ * @tparam C_  number of columns
+ * @tparam K_  number of tokens in a row required to win
+ */
+template <size_t L_, size_t C_, size_t K_> struct FixedGameState : GameState
+{
+    typedef FixedGeometry<L_, C_, K_> Geometry;
+
+    /// Tells whether a game state has this geometry.
+    static bool match(GameState const& g) {
+        return g.L() == L_ && g.C() == C_ && g.nb_required_to_win() == K_;
+    }
+    /** Conversion constructor.
+     * @pre <tt>match(g)</tt>, checked with an assertion
+     */
+    explicit FixedGameState(GameState const& g) : GameState(g) {
+        assert(match(g));
+    }
+
+    /// Assigns a \c Square with a player token.
+    bool set(Move m, PlayerId p) {
+        return set_in(Geometry(), m, p);
+    }
+    /// Empties a \c Square of any a player token.
+    void reset(Move m) {
+        reset_in(Geometry(), m);
+    }
+    /// Checks whether a given move is a winning move.
+    bool is_a_winning_move_for(Move m, PlayerId p) const {
+        return is_a_winning_move_in(Geometry(), m, p);
+    }
+};
+
+/** %Game.
+ * A \c GameState played by a list of \link Player players\endlink.
+ */
+struct Game : GameState
+{
+    /// Init constructor.
+    Game(size_t L_=3, size_t C_=0, size_t nb_required_to_win = 0)
+        : GameState(L_, C_, nb_required_to_win)
+        , m_log(&std::cout)
+        {}
+    /// Init constructor: the game starts from the given state.
+    explicit Game(GameState const& state)
+        : GameState(state)
+        , m_log(&std::cout)
+        {}
+
+    /** Adds a new player to the game.
+     * @param[in] player  New player (decision centre) to add, and takes
+     * responsibility of.
+     * @param[in] name    Name of the new player.
+     * @pre the \c player shall not be null, checked by assertion.
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    void push(std::unique_ptr<PlayerDC> && player, std::string && name) {
+        assert(player);
+        m_players.push_back(Player(std::move(player), std::move(name)));
+    }
+
+    /** Plays a move for the player whose turn it is.
+     * Unlike \c set(), the move is accounted in the game progress.
+     * @param[in] m  move
+     * @return whether the square was free.
+     * @throw None
+     */
+    bool play(Move m) {
+        if (!set(m, next_player())) {
+            return false;
+        }
+        m_nb_moves ++;
+        return true;
+    }
+    /// Player whose turn it is.
+    PlayerId next_player() const {
+        return m_nb_moves%2 == 0 ? PlayerId::first : PlayerId::second;
+    }
+    /// Number of moves played.
+    size_t nb_moves() const { return m_nb_moves; }
+
+    /** Sets the stream where the game is commented.
+     * @param[in] log  stream, or \c nullptr for silent games
+     */
+    void log_to(std::ostream * log) { m_log = log; }
+    /// Stream where the game is commented, \c nullptr if silent.
+    std::ostream * log() const { return m_log; }
+
+    /**
+     * Game main function.
+     * This function iterates until a player wins, or there is a draw.
+     * @return the id of the winner, as a \c size_t, or 0 for a draw.
+     * @pre The number of registered players shall be 2; unchecked.
+     * @post Either one player has won, or a draw has been established.
+     */
+    size_t run()
+    {
+        // Players shall not think once the game is over, whatever the way
+        struct PonderingGuard {
+            ~PonderingGuard() {
+                for (Player const& p : players) p.stop_pondering();
+            }
+            std::vector<Player> const& players;
+        } guard{m_players};
+        PlayerId player = next_player();
+        while (m_nb_moves != L() * C()) {
+            Player & p =  m_players[size_t(player)-1];
+            if (m_log) {
+                *m_log
+                    <<"Moves: " << m_nb_moves
+                    << " ; Player " << size_t(player) << ", " << p.name() << ", ";
+            }
+            const Move m = p.choose(*this);
+            assert(m < L() * C()); // choose() post constract
+            if (set(m, player)) {
+                if (m_log) *m_log << board();
+                if (is_a_winning_move_for(m, player)) {
+                    if (m_log) *m_log << "Player " << size_t(player) << ", " << p.name() << ", has won!\n";
+                    return size_t(player);
+                }
+                player++;
+                m_nb_moves ++;
+                p.ponder(*this);
+            } else if (m_log) {
+                *m_log << "Cannot play there, try again.\n";
+            }
+        }
+        if (m_log) *m_log << "Draw. Nobody wins.\n";
+        return 0;
+    }
+private:
+    /**@name Game static data */
+    //@{
+    std::vector<Player> m_players;
+    std::ostream *      m_log;
+    //@}
+};
+
+std::istream & operator>>(std::istream & is,  GameState & v)
+{
+    std::vector<std::string> lines;
+    std::string line;
+    size_t C = 0;
+    while (std::getline(is, line)) { // till eof
+        if (line[0] == '|') {
+            lines.push_back(line);
+            C =  (line.size()-1)/2;
+        } else if (line == "<<EOF") {
+            break;
+        }
+    }
+    // if (is) {
+        Board b(lines.size(), C);
+        v.m_nb_moves = 0;
+        for (size_t l=0, L=b.L(); l!=L ; ++l) {
+            for (size_t c=0,C=b.C(); c!=C ; ++c) {
+                switch (lines[l][c*2+1]) {
+                    case 'X':
+                        b.set(l,c,SquareValue::first);
+                        v.m_nb_moves++;
+                        break;
+                    case 'O':
+                        b.set(l,c,SquareValue::second);
+                        v.m_nb_moves++;
+                        break;
+                }
+            }
+        }
+        // std::cout << b;
+        v.m_board = std::move(b);
+        v.refresh();
+    // }
+    return is ;
+}
+//@}
+
+/*===========================================================================*/
+/*==========================[ Transposition Table ]==========================*/
+/*===========================================================================*/
+/**@defgroup gSearch AI search helpers
+ * @ingroup gPlayerAI
+ * @{
+ */
+/** Transposition table.
+ * Fixed-size hash table that remembers the result of the positions
+ * already searched: the depth of the search, the kind of bound obtained,
+ * the score, and the best move found. It is indexed by the Zobrist hash
+ * of the positions; searches use the hash of their canonical form (\c
+ * GameState::canonical_symmetry()) so that symmetric positions share
+ * their entry.
+ *
+ * When two positions collide on the same slot, the newest one replaces
+ * the oldest, unless the oldest has been searched deeper.
+ *
+ * The table may be shared by several threads without locks: each slot
+ * is made of two atomic words, the entry and the key xored with the
+ * entry. A slot half written by another thread won't match the key
+ * searched, and will be ignored.
+ */
+struct TranspositionTable
+{
+    /// Kind of score stored.
+    enum class Bound : std::uint8_t {
+        none,  ///< empty slot
+        exact, ///< exact score
+        lower, ///< score is a lower bound (fail-high)
+        upper  ///< score is an upper bound (fail-low)
+    };
+    /// Data stored for a position.
+    struct Entry {
+        std::int16_t  score;
+        std::uint8_t  depth;
+        Bound         bound;
+        Move          move;  ///< best move, \c no_move if none
+    };
+
+    /** Init constructor.
+     * @param[in] size_in_MB  memory allocated to the table. The table is
+     * disabled when 0.
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    explicit TranspositionTable(size_t size_in_MB) : m_slots(nullptr), m_size(0) {
+        size_t nb = (size_in_MB << 20) / sizeof(Slot);
+        size_t size = nb ? 1 : 0;
+        while (size && size*2 <= nb) size *= 2;
+        m_owned.reset(new Slot[size]);
+        m_slots = m_owned.get();
+        m_size = size;
+        clear();
+    }
+    /** Init constructor over memory owned by someone else.
+     * The table is read from, and written to, this memory as it is: it
+     * is not cleared.
+     * @param[in] memory  \c bytes(nb_slots) bytes, suitably aligned,
+     * which shall outlive the table
+     * @param[in] nb_slots  number of slots, a power of 2
+     */
+    TranspositionTable(void * memory, size_t nb_slots)
+        : m_slots(static_cast<Slot*>(memory)), m_size(nb_slots) {
+        assert((nb_slots & (nb_slots-1)) == 0);
+    }
+    /// Memory required by a number of slots.
+    static size_t bytes(size_t nb_slots) { return nb_slots * sizeof(Slot); }
+
+    /** Searches for a position.
+     * @param[in] key  hash of the position
+     * @param[out] e  entry associated to the position, if found
+     * @return whether the position is known.
+     */
+    bool probe(std::uint64_t key, Entry & e) const {
+        if (!m_size) return false;
+        Slot const& slot = m_slots[key & (m_size-1)];
+        const std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+        const std::uint64_t check = slot.check.load(std::memory_order_relaxed);
+        if ((check ^ data) != key) return false;
+        e = unpack(data);
+        return e.bound != Bound::none;
+    }
+    /** Records the result of a search.
+     * @param[in] score  score, as returned by \c score_to_tt()
+     */
+    void store(std::uint64_t key, size_t depth, Bound bound, int score, Move move) {
+        if (!m_size) return;
+        Slot & slot = m_slots[key & (m_size-1)];
+        const std::uint64_t old_data = slot.data.load(std::memory_order_relaxed);
+        const std::uint64_t old_key  = slot.check.load(std::memory_order_relaxed) ^ old_data;
+        const Entry old = unpack(old_data);
+        if (old.bound != Bound::none && old_key != key && old.depth > depth) {
+            return;
+        }
+        const Entry e = {
+            std::int16_t(score),
+            std::uint8_t(std::min<size_t>(depth, std::numeric_limits<std::uint8_t>::max())),
+            bound,
+            move
+        };
+        const std::uint64_t data = pack(e);
+        slot.data.store(data, std::memory_order_relaxed);
+        slot.check.store(key ^ data, std::memory_order_relaxed);
+    }
+    /// Forgets everything.
+    void clear() {
+        for (size_t i=0; i!=m_size ; ++i) {
+            m_slots[i].data.store(0, std::memory_order_relaxed);
+            m_slots[i].check.store(0, std::memory_order_relaxed);
+        }
+    }
+    /// Number of slots.
+    size_t size() const { return m_size; }
+
+    /** Converts a score to store it.
+     * Winning scores depend on the remaining depth where the win has been
+     * found; they are stored relatively to the current node in order to
+     * be reused at a different depth.
+     */
+    static int score_to_tt(int score, size_t depth) {
+        return score >  win_threshold ? score + int(depth)
+            :  score < -win_threshold ? score - int(depth)
+            :                           score;
+    }
+    /// Converts back a score from the table, see \c score_to_tt()
+    static int score_from_tt(int score, size_t depth) {
+        return score >  win_threshold ? score - int(depth)
+            :  score < -win_threshold ? score + int(depth)
+            :                           score;
+    }
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> check;
+        std::atomic<std::uint64_t> data;
+    };
+    static std::uint64_t pack(Entry const& e) {
+        return std::uint64_t(std::uint16_t(e.score))
+            |  std::uint64_t(e.depth)        << 16
+            |  std::uint64_t(e.bound)        << 24
+            |  std::uint64_t(e.move)         << 32;
+    }
+    static Entry unpack(std::uint64_t data) {
+        const Entry e = {
+            std::int16_t(std::uint16_t(data)),
+            std::uint8_t(data >> 16),
+            Bound(std::uint8_t(data >> 24)),
+            Move(data >> 32)
+        };
+        return e;
+    }
+
+    static_assert(sizeof(std::atomic<std::uint64_t>) == sizeof(std::uint64_t),
+            "Slots shall be stored as raw words");
+
+    static const int win_threshold = 900;
+    std::unique_ptr<Slot[]> m_owned;
+    Slot *                  m_slots;
+    size_t                  m_size;
+};
+
+/** Transposition table kept in a file, and shared by processes.
+ * The file is mapped in memory as it is, with no parse step: a header,
+ * followed by the slots of a \c TranspositionTable. Processes that map
+ * the same file share its entries as threads share the table in
+ * memory, without locks.
+ *
+ * Results depend on the size of the board, on the number of tokens to
+ * align, on the radius of the moves searched, and on the settings of
+ * the selective search: the keys of the positions are salted with
+ * them, see \c salt(). They also depend on
+ * the evaluation, and on the search itself: \c version shall be
+ * increased when they change, so that older files are rejected.
+ */
+struct PersistentCache
+{
+    /** Init constructor: maps a file.
+     * @param[in] filename  cache file
+     * @param[in] writable  whether the searches write to the cache;
+     * the file is created when it does not exist.
+     * @param[in] size_in_MB  size of the file, when it is created
+     * @throw std::runtime_error if the file cannot be opened, created or
+     * mapped, or if it is not a cache of this version.
+     */
+    PersistentCache(std::string const& filename, bool writable, size_t size_in_MB)
+        : m_writable(writable), m_memory(nullptr), m_length(0) {
+#if HAVE_POSIX
+        const int fd = ::open(filename.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open " + filename);
+        }
+        try {
+            map(fd, filename, size_in_MB);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+#else
+        throw std::runtime_error("Persistent caches are not supported on this system");
+#endif
+    }
+    ~PersistentCache() {
+#if HAVE_POSIX
+        if (m_memory) ::munmap(m_memory, m_length);
+#endif
+    }
+    PersistentCache           (PersistentCache const&) = delete;
+    PersistentCache& operator=(PersistentCache const&) = delete;
+
+    /// Table stored in the file.
+    TranspositionTable       & table()       { return *m_table; }
+    TranspositionTable const& table() const { return *m_table; }
+    /// Whether the searches write to the cache.
+    bool writable() const { return m_writable; }
+
+    /** Salt of the keys of the positions of a game.
+     * It is xored with the hashes of the positions.
+     * @param[in] g  game searched
+     * @param[in] settings  settings of the search that change its
+     * results, 0 for the default ones
+     */
+    static std::uint64_t salt(GameState const& g, std::uint64_t settings = 0) {
+        std::uint64_t h = 0x9E3779B97F4A7C15;
+        // The default settings are not mixed, so that older files keep
+        // their salt
+        const size_t nb = settings ? 5 : 4;
+        const std::uint64_t values[5] = {std::uint64_t(g.L()), std::uint64_t(g.C()),
+                std::uint64_t(g.nb_required_to_win()), std::uint64_t(g.candidate_radius()), settings};
+        for (size_t k = 0; k != nb ; ++k) {
+            // splitmix64 steps
+            h = (h ^ values[k]) * 0xBF58476D1CE4E5B9;
+            h = (h ^ (h >> 27)) * 0x94D049BB133111EB;
+            h ^= h >> 31;
+        }
+        return h;
+    }
+
+    /// Version of the searches whose results are stored.
+    static const std::uint32_t version = 1;
+
+private:
+    /// Header of the file, followed by the slots.
+    struct Header {
+        char          magic[8];
+        std::uint32_t version;
+        std::uint32_t reserved;
+        std::uint64_t nb_slots;
+        std::uint8_t  padding[40];
+    };
+    static_assert(sizeof(Header) == 64, "Slots shall be aligned on cache lines");
+
+#if HAVE_POSIX
+    void map(int fd, std::string const& filename, size_t size_in_MB) {
+        static const char magic[8] = {'T','T','T','C','A','C','H','E'};
+        // Processes that create the file at once wait for each other
+        struct Lock {
+            explicit Lock(int fd_) : fd(fd_) { ::flock(fd, LOCK_EX); }
+            ~Lock() { ::flock(fd, LOCK_UN); }
+            int fd;
+        } lock(fd);
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            throw std::runtime_error("Cannot read " + filename);
+        }
+        if (st.st_size == 0 && m_writable) {
+            size_t nb = (size_in_MB << 20) / TranspositionTable::bytes(1);
+            size_t nb_slots = nb ? 1 : 0;
+            while (nb_slots && nb_slots*2 <= nb) nb_slots *= 2;
+            Header h = {};
+            std::copy(magic, magic+8, h.magic);
+            h.version  = version;
+            h.nb_slots = nb_slots;
+            // The slots are zeroed by the file system
+            if (::ftruncate(fd, off_t(sizeof(Header) + TranspositionTable::bytes(nb_slots))) != 0
+                    || ::pwrite(fd, &h, sizeof(h), 0) != ssize_t(sizeof(h))
+                    || ::fstat(fd, &st) != 0) {
+                throw std::runtime_error("Cannot create " + filename);
+            }
+        }
+        Header h;
+        if (size_t(st.st_size) < sizeof(Header)
+                || ::pread(fd, &h, sizeof(h), 0) != ssize_t(sizeof(h))
+                || !std::equal(magic, magic+8, h.magic)
+                || h.version != version
+                || (h.nb_slots & (h.nb_slots-1)) != 0
+                || size_t(st.st_size) != sizeof(Header) + TranspositionTable::bytes(h.nb_slots)) {
+            throw std::runtime_error(filename + " is not a cache of version " + std::to_string(version));
+        }
+        m_length = size_t(st.st_size);
+        void * memory = ::mmap(nullptr, m_length, m_writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        if (memory == MAP_FAILED) {
+            throw std::runtime_error("Cannot map " + filename);
+        }
+        try {
+            m_table.reset(new TranspositionTable(static_cast<char*>(memory) + sizeof(Header), size_t(h.nb_slots)));
+        } catch (...) {
+            ::munmap(memory, m_length);
+            throw;
+        }
+        m_memory = memory;
+    }
+#endif
+
+    const bool                          m_writable;
+    void *                              m_memory;
+    size_t                              m_length;
+    std::unique_ptr<TranspositionTable> m_table;
+};
+
+/** Exact values of all the positions of a small board.
+ * Positions are indexed in base 3, a digit per square (0: free, 1:
+ * first player, 2: second player). Each position is stored in a byte:
+ * its value for the player to move in the 2 low bits, and the number of
+ * plies till the end of the game, with perfect play, in the 6 high
+ * bits. The winner takes the shortest way, the loser the longest.
+ *
+ * The values are computed by a retrograde analysis: the positions with
+ * the most tokens are solved first, then the positions with one token
+ * less, whose moves lead to positions already solved, and so on till
+ * the empty board. The positions of each layer are solved by all the
+ * cores at once. Every position with as many tokens of the first player
+ * as of the second, or one more, is solved, reachable or not.
+ *
+ * The table is stored in a file, after a header, and mapped in memory
+ * as it is.
+ */
+struct Tablebase
+{
+    /// Value of a position, for the player to move.
+    enum class Value : std::uint8_t { unknown, win, draw, loss };
+    /// Entry of a position.
+    struct Entry {
+        Value  value;
+        size_t distance; ///< plies till the end of the game
+    };
+    /// Maximal number of squares of a board: the table takes 3^16 bytes.
+    static const size_t max_squares = 16;
+
+    /** Init constructor: maps the table of a file.
+     * @throw std::runtime_error if the file cannot be opened or mapped,
+     * or if it is not a table of this version.
+     */
+    explicit Tablebase(std::string const& filename)
+        : m_memory(nullptr), m_length(0), m_entries(nullptr), m_L(0), m_C(0), m_K(0) {
+#if HAVE_POSIX
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open " + filename);
+        }
+        struct stat st;
+        Header h;
+        const bool valid = ::fstat(fd, &st) == 0
+            && size_t(st.st_size) >= sizeof(Header)
+            && ::pread(fd, &h, sizeof(h), 0) == ssize_t(sizeof(h))
+            && std::equal(magic, magic+8, h.magic)
+            && h.version == version
+            && h.L*h.C <= max_squares
+            && size_t(st.st_size) == sizeof(Header) + nb_positions(h.L*h.C);
+        void * memory = valid
+            ? ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0)
+            : MAP_FAILED;
+        ::close(fd);
+        if (!valid) {
+            throw std::runtime_error(filename + " is not a tablebase of version " + std::to_string(version));
+        } else if (memory == MAP_FAILED) {
+            throw std::runtime_error("Cannot map " + filename);
+        }
+        m_memory  = memory;
+        m_length  = size_t(st.st_size);
+        m_entries = static_cast<std::uint8_t const*>(memory) + sizeof(Header);
+        m_L = h.L; m_C = h.C; m_K = h.K;
+        init_powers();
+#else
+        throw std::runtime_error("Tablebases are not supported on this system");
+#endif
+    }
+    ~Tablebase() {
+#if HAVE_POSIX
+        if (m_memory) ::munmap(m_memory, m_length);
+#endif
+    }
+    Tablebase           (Tablebase const&) = delete;
+    Tablebase& operator=(Tablebase const&) = delete;
+
+    /** Solves all the positions of a board, and writes their table.
+     * @param[in] L, C  dimensions of the board
+     * @param[in] K  number of tokens in a row required to win
+     * @param[in] filename  file written
+     * @param[in] nb_threads  number of threads used
+     * @throw std::runtime_error if the board has more than \c
+     * max_squares squares, or if the file cannot be written.
+     * @throw std::bad_alloc if memory is exhausted.
+     * @throw std::system_error if threads cannot be started.
+     */
+    static void build(size_t L, size_t C, size_t K, std::string const& filename, size_t nb_threads) {
+        if (L*C > max_squares) {
+            throw std::runtime_error("Tablebases are limited to boards of "
+                    + std::to_string(max_squares) + " squares");
+        }
+        const std::vector<std::uint8_t> entries = solve(L, C, K, std::max<size_t>(nb_threads, 1));
+        Header h = {};
+        std::copy(magic, magic+8, h.magic);
+        h.version = version;
+        h.L = std::uint32_t(L); h.C = std::uint32_t(C); h.K = std::uint32_t(K);
+        std::ofstream f(filename, std::ios::binary);
+        f.write(reinterpret_cast<char const*>(&h), sizeof(h));
+        f.write(reinterpret_cast<char const*>(entries.data()), std::streamsize(entries.size()));
+        if (!f) {
+            throw std::runtime_error("Cannot write " + filename);
+        }
+    }
+
+    /// Tells whether the table is the one of the board of a game.
+    bool match(GameState const& g) const {
+        return g.L() == m_L && g.C() == m_C && g.nb_required_to_win() == m_K;
+    }
+    /** Entry of a position.
+     * @pre <tt>match(g)</tt>, unchecked
+     * @throw None
+     */
+    Entry probe(GameState const& g) const {
+        size_t index = 0;
+        for (SquareValue v : {SquareValue::first, SquareValue::second}) {
+            g.board().stones(v).for_each_bit([&](size_t i) -> bool {
+                    index += m_powers[i] * (size_t(v)-size_t(SquareValue::unoccupied));
+                    return true;
+                });
+        }
+        return unpack(m_entries[index]);
+    }
+
+    /// Version of the table format, and of the rules.
+    static const std::uint32_t version = 1;
+
+private:
+    struct Header {
+        char          magic[8];
+        std::uint32_t version;
+        std::uint32_t L;
+        std::uint32_t C;
+        std::uint32_t K;
+        std::uint8_t  padding[40];
+    };
+    static_assert(sizeof(Header) == 64, "Entries shall be aligned on cache lines");
+    static const char magic[8];
+
+    static size_t nb_positions(size_t nb_squares) {
+        size_t n = 1;
+        for (size_t i=0; i!=nb_squares ; ++i) n *= 3;
+        return n;
+    }
+    void init_powers() {
+        for (size_t i=0, p=1; i!=m_powers.size() ; ++i, p*=3) m_powers[i] = p;
+    }
+    static std::uint8_t pack(Value v, size_t distance) {
+        return std::uint8_t(size_t(v) | distance << 2);
+    }
+    static Entry unpack(std::uint8_t e) {
+        return Entry{Value(e & 3), size_t(e >> 2)};
+    }
+
+    /// Retrograde analysis, see \c Tablebase.
+    static std::vector<std::uint8_t> solve(size_t L, size_t C, size_t K, size_t nb_threads) {
+        const size_t N     = L*C;
+        const size_t total = nb_positions(N);
+        const WinningLines lines(L, C, K);
+        std::vector<size_t> powers(N);
+        for (size_t i=0, p=1; i!=N ; ++i, p*=3) powers[i] = p;
+        // Tokens of each player in the low and in the high squares, so
+        // that the layer of a position is found without decoding it
+        const size_t half = N/2;
+        const size_t low  = nb_positions(half);
+        std::vector<std::array<std::uint8_t, 2>> low_counts(low), high_counts(total/low);
+        for (auto * counts : {&low_counts, &high_counts}) {
+            for (size_t k=0; k!=counts->size() ; ++k) {
+                std::array<std::uint8_t, 2> c = {{0, 0}};
+                for (size_t d=k; d ; d/=3) {
+                    if (d%3) c[d%3-1] ++;
+                }
+                (*counts)[k] = c;
+            }
+        }
+
+        std::vector<std::uint8_t> entries(total, pack(Value::unknown, 0));
+        for (size_t n = N+1; n-- > 0 ; ) {
+            // First player moves first
+            const size_t nb_first  = (n+1)/2;
+            const size_t nb_second = n/2;
+            std::atomic<size_t> next(0);
+            auto layer = [&]() {
+                const size_t chunk = 1 << 16;
+                for (size_t begin ; (begin = next.fetch_add(chunk)) < total ; ) {
+                    for (size_t index = begin, end = std::min(begin+chunk, total); index != end ; ++index) {
+                        std::array<std::uint8_t, 2> const& l = low_counts[index % low];
+                        std::array<std::uint8_t, 2> const& h = high_counts[index / low];
+                        if (size_t(l[0]+h[0]) == nb_first && size_t(l[1]+h[1]) == nb_second) {
+                            entries[index] = solve(index, n, N, powers, lines, entries);
+                        }
+                    }
+                }
+            };
+            std::vector<std::thread> threads;
+            try {
+                for (size_t t=1; t < nb_threads ; ++t) threads.emplace_back(layer);
+            } catch (...) {
+                next.store(total);
+                for (auto & t : threads) t.join();
+                throw;
+            }
+            layer();
+            for (auto & t : threads) t.join();
+        }
+        return entries;
+    }
+    /// Solves a position whose children are solved.
+    static std::uint8_t solve(size_t index, size_t n, size_t N, std::vector<size_t> const& powers,
+            WinningLines const& lines, std::vector<std::uint8_t> const& entries) {
+        std::array<Mask, 2> stones;
+        for (size_t i=0, d=index; i!=N ; ++i, d/=3) {
+            if (d%3) stones[d%3-1].set(i);
+        }
+        // The adversary has just played: has she won?
+        const size_t to_move = n % 2;
+        Mask const&  last    = stones[1-to_move];
+        bool won = false;
+        last.for_each_bit([&](size_t i) -> bool {
+                won = lines.completes_a_line(i, last);
+                return !won;
+            });
+        if (won) {
+            return pack(Value::loss, 0);
+        } else if (n == N) {
+            return pack(Value::draw, 0);
+        }
+        Value  best     = Value::unknown;
+        size_t distance = 0;
+        for (size_t i=0; i!=N ; ++i) {
+            if (stones[0].test(i) || stones[1].test(i)) continue;
+            const Entry child = unpack(entries[index + powers[i] * (to_move+1)]);
+            // The child is valued for the adversary
+            if (child.value == Value::loss) {
+                if (best != Value::win || child.distance+1 < distance) {
+                    best = Value::win; distance = child.distance+1;
+                }
+            } else if (child.value == Value::draw) {
+                if (best != Value::win && (best != Value::draw || child.distance+1 < distance)) {
+                    best = Value::draw; distance = child.distance+1;
+                }
+            } else if (best == Value::unknown || (best == Value::loss && child.distance+1 > distance)) {
+                best = Value::loss; distance = child.distance+1;
+            }
+        }
+        return pack(best, distance);
+    }
+
+    void *               m_memory;
+    size_t               m_length;
+    std::uint8_t const*  m_entries;
+    size_t               m_L;
+    size_t               m_C;
+    size_t               m_K;
+    std::array<size_t, max_squares> m_powers;
+};
+const char Tablebase::magic[8] = {'T','T','T','B','A','S','E','S'};
+
+/** Table of the proof and disproof numbers of a proof-number search.
+ * Fixed-size hash table indexed by the Zobrist hash of the positions.
+ * Slots go by pairs: a new position replaces the one of the pair that
+ * required the smallest search, so that the most expensive results are
+ * kept when the table is full.
+ * @note Unlike \c TranspositionTable, it is not meant to be shared by
+ * several threads.
+ */
+struct ProofNumberTable
+{
+    /// Data stored for a position.
+    struct Entry {
+        std::uint32_t phi;   ///< proof number of the player to move
+        std::uint32_t delta; ///< disproof number of the player to move
+        std::uint32_t work;  ///< number of nodes searched to obtain them
+    };
+    /// Proof number of a goal that cannot be reached.
+    static const std::uint32_t infinity = 0x7FFFFFFF;
+
+    /** Init constructor.
+     * @param[in] size_in_MB  memory allocated to the table; at least one
+     * pair of slots is allocated.
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    explicit ProofNumberTable(size_t size_in_MB) {
+        size_t nb = (size_in_MB << 20) / sizeof(Slot);
+        size_t size = 2;
+        while (size*2 <= nb) size *= 2;
+        m_slots.reset(new Slot[size]);
+        m_size = size;
+        clear();
+    }
+
+    /** Searches for a position.
+     * @param[in] key  hash of the position
+     * @param[out] e  entry associated to the position, if found
+     * @return whether the position is known.
+     */
+    bool probe(std::uint64_t key, Entry & e) const {
+        Slot const* pair = &m_slots[key & (m_size-2)];
+        for (size_t i=0; i!=2 ; ++i) {
+            if (pair[i].key == key && pair[i].entry.work) {
+                e = pair[i].entry;
+                return true;
+            }
+        }
+        return false;
+    }
+    /// Records the proof numbers of a position.
+    void store(std::uint64_t key, Entry const& e) {
+        Slot * pair = &m_slots[key & (m_size-2)];
+        Slot & slot = pair[0].key == key ? pair[0]
+            :         pair[1].key == key ? pair[1]
+            : pair[0].entry.work <= pair[1].entry.work ? pair[0] : pair[1];
+        slot.key   = key;
+        slot.entry = e;
+    }
+    /// Forgets everything.
+    void clear() {
+        const Slot empty = { 0, { 0, 0, 0 } };
+        std::fill(&m_slots[0], &m_slots[0] + m_size, empty);
+    }
+    /// Number of slots.
+    size_t size() const { return m_size; }
+private:
+    struct Slot {
+        std::uint64_t key;
+        Entry         entry; ///< empty when \c entry.work is null
+    };
+    std::unique_ptr<Slot[]> m_slots;
+    size_t                  m_size;
+};
+
+/** Pool of objects allocated by blocks of consecutive objects.
+ * The memory is allocated once for all, and the objects are never freed
+ * one by one: the whole pool is cleared at once. Blocks are identified
+ * by the index of their first object, which stays valid until the pool
+ * is cleared.
+ *
+ * Several threads may allocate blocks at once.
+ * @note The objects are default constructed once, when the pool is
+ * built: they are to be initialized after each allocation.
+ */
+template <class T> struct Arena
+{
+    /// Index returned when the pool is exhausted.
+    static const size_t npos = size_t(-1);
+
+    /** Init constructor.
+     * @param[in] size_in_MB  memory allocated to the pool; it holds at
+     * least one object.
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    explicit Arena(size_t size_in_MB)
+        : m_capacity(std::max<size_t>((size_in_MB << 20) / sizeof(T), 1))
+        , m_objects(new T[m_capacity])
+        , m_used(0)
+        {}
+
+    /** Allocates a block of objects.
+     * @param[in] n  number of objects
+     * @return the index of the first object, or \c npos when the pool is
+     * exhausted.
+     * @throw None
+     */
+    size_t allocate(size_t n) noexcept {
+        if (m_used.load(std::memory_order_relaxed) + n > m_capacity) {
+            return npos;
+        }
+        const size_t first = m_used.fetch_add(n, std::memory_order_relaxed);
+        return first + n <= m_capacity ? first : npos;
+    }
+    /// Frees all the objects.
+    void clear() noexcept { m_used.store(0, std::memory_order_relaxed); }
+    /// Number of objects allocated.
+    size_t size() const noexcept { return std::min(m_used.load(std::memory_order_relaxed), m_capacity); }
+    /// Maximal number of objects.
+    size_t capacity() const noexcept { return m_capacity; }
+
+    T      & operator[](size_t i)       noexcept { assert(i < m_capacity); return m_objects[i]; }
+    T const& operator[](size_t i) const noexcept { assert(i < m_capacity); return m_objects[i]; }
+private:
+    const size_t         m_capacity;
+    std::unique_ptr<T[]> m_objects;
+    std::atomic<size_t>  m_used;
+};
+//@}
+
+/*===========================================================================*/
+/*==============================[ Move ordering ]============================*/
+/*===========================================================================*/
+/**@addtogroup gSearch
+ * @{
+ */
+/** List of moves, extracted by decreasing priority.
+ * The moves are sorted lazily: as alpha-beta cutoffs usually happen on
+ * the first moves, only the moves actually extracted are sorted.
+ */
+struct MoveList
+{
+    MoveList() : m_size(0), m_next(0) {}
+    /// Adds a move.
+    void push(Move m, int priority) {
+        assert(m_size < Mask::max_squares);
+        m_moves[m_size]      = m;
+        m_priorities[m_size] = priority;
+        ++m_size;
+    }
+    /** Extracts the next move with the highest priority.
+     * @return \c false if all the moves have been extracted.
+     */
+    bool next(Move & m) {
+        if (m_next == m_size) {
+            return false;
+        }
+        size_t best = m_next;
+        for (size_t i = m_next+1; i < m_size ; ++i) {
+            if (m_priorities[i] > m_priorities[best]) best = i;
+        }
+        std::swap(m_moves[best],      m_moves[m_next]);
+        std::swap(m_priorities[best], m_priorities[m_next]);
+        m = m_moves[m_next++];
+        return true;
+    }
+    /// Number of moves.
+    size_t size() const { return m_size; }
+private:
+    std::array<Move, Mask::max_squares> m_moves;
+    std::array<int,       Mask::max_squares> m_priorities;
+    size_t                                   m_size;
+    size_t                                   m_next;
+};
+
+/** Move ordering heuristics.
+ * The earlier the best move is searched, the sooner alpha-beta cutoffs
+ * happen. The moves are tried in the following order:
+ * -# the hash move, i.e. the best move stored in the transposition
+ *    table,
+ * -# the killer moves: the last two moves that have produced a cutoff
+ *    at the same ply,
+ * -# the other moves, by decreasing history score (how many cutoffs the
+ *    move has produced, weighted by the depth), plus a small static
+ *    bonus for squares next to other tokens, and close to the centre.
+ */
+struct MoveOrdering
+{
+    MoveOrdering() : m_L(0), m_C(0) {
+        for (auto & h : m_history) h.fill(0);
+    }
+
+    /** Prepares a new search.
+     * The static tables are rebuilt if the board dimensions have
+     * changed, the killer moves are forgotten, and the history is aged.
+     */
+    void new_search(Board const& b) {
+        if (b.L() != m_L || b.C() != m_C) {
+            prepare(b.L(), b.C());
+        }
+        m_killers.clear();
+        for (auto & h : m_history)
+            for (auto & v : h)
+                v /= 2;
+    }
+
+    /** Generates the moves from a position, with their priorities.
+     * @param[in] b  current board
+     * @param[in] candidates  moves to generate
+     * @param[in] ply  distance to the root of the search
+     * @param[in] who  player that will play the moves
+     * @param[in] hash_move  move to search first, may be \c no_move
+     * @param[out] moves  list of the moves generated
+     */
+    void generate(Board const& b, Mask const& candidates, size_t ply, PlayerId who, Move hash_move, MoveList & moves) {
+        const Mask occupied = b.stones(SquareValue::first) | b.stones(SquareValue::second);
+        const killers_type & killers = killers_at(ply);
+        auto const& history = m_history[size_t(who)-1];
+        candidates.for_each_bit([&](size_t i) -> bool {
+                const Move m = Move(i);
+                const int priority
+                    = m == hash_move  ? hash_priority
+                    : m == killers[0] ? killer_priority
+                    : m == killers[1] ? killer_priority-1
+                    : int(history[i])
+                    + int((m_neighbours[i] & occupied).count()) * neighbour_bonus
+                    + m_centrality[i];
+                moves.push(m, priority);
+                return true;
+            });
+    }
+
+    /** Records a move that has produced a cutoff.
+     * @param[in] m  move played
+     * @param[in] ply  distance to the root of the search
+     * @param[in] who  player that has played the move
+     * @param[in] depth  depth of the search after the move
+     */
+    void on_cutoff(Move m, size_t ply, PlayerId who, size_t depth) {
+        killers_type & killers = killers_at(ply);
+        if (killers[0] != m) {
+            killers[1] = killers[0];
+            killers[0] = m;
+        }
+        auto & history = m_history[size_t(who)-1];
+        history[m] += (depth+1)*(depth+1);
+        if (history[m] > max_history) {
+            for (auto & h : m_history)
+                for (auto & v : h)
+                    v /= 2;
+        }
+    }
+
+private:
+    typedef std::array<Move, 2> killers_type;
+
+    void prepare(size_t L, size_t C) {
+        m_L = L;
+        m_C = C;
+        const size_t N = L*C;
+        m_neighbours.assign(N, Mask());
+        m_centrality.assign(N, 0);
+        for (size_t l=0; l!=L ; ++l) {
+            for (size_t c=0; c!=C ; ++c) {
+                const size_t i = l*C+c;
+                for (size_t nl = l ? l-1 : l ; nl <= l+1 && nl < L ; ++nl)
+                    for (size_t nc = c ? c-1 : c ; nc <= c+1 && nc < C ; ++nc)
+                        if (nl != l || nc != c)
+                            m_neighbours[i].set(nl*C+nc);
+                m_centrality[i] = int(L+C)
+                    - std::abs(int(2*l+1) - int(L)) - std::abs(int(2*c+1) - int(C));
+            }
+        }
+    }
+
+    killers_type & killers_at(size_t ply) {
+        if (ply >= m_killers.size()) {
+            m_killers.resize(ply+1, killers_type{{no_move, no_move}});
+        }
+        return m_killers[ply];
+    }
+
+    static const int      hash_priority   = 1 << 30;
+    static const int      killer_priority = 1 << 29;
+    static const int      neighbour_bonus = 64;
+    static const unsigned max_history     = 1 << 24;
+
+    size_t                                          m_L;
+    size_t                                          m_C;
+    std::vector<Mask>                               m_neighbours;
+    std::vector<int>                                m_centrality;
+    std::vector<killers_type>                       m_killers;
+    std::array<std::array<unsigned, Mask::max_squares>, 2> m_history;
+};
+//@}
+
+/*===========================================================================*/
+/*========================[ Player Decision Centres ]========================*/
+/*===========================================================================*/
+
+/*===============================[ LocalPlayerDC : cin/cout ]================*/
+/**@ingroup gPlayerAI
+ * Player decision centre that delegates decisions to a human player
+ * through text console.
+ */
+struct LocalPlayerDC : PlayerDC {
+    virtual Move choose(Game & g) const {
+        size_t l, c;
+        while (! (std::cout << "Where? (row col)" && (std::cin >> l >> c) && l<g.L() && c<g.C())) {
+            if (std::cin.eof()) {
+                throw std::runtime_error("\nAh ah, you gave up!");
+            } else if (std::cin.fail()) {
+                std::cin.clear();
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                std::cout << "Invalid numbers, try again: ";
+            } else if (l>=g.L()) {
+                std::cout << "line out of range [0,"<<g.L()<<"[, try again: ";
+            } else if (c>=g.C()) {
+                std::cout << "column out of range [0,"<<g.C()<<"[, try again: ";
+            } else {
+                assert(!"unexpected case");
+            }
+        }
+        return Move(g.board().index(l, c));
+    }
+};
+
+/*===============================[ AIPlayerDC : iterative deepening ]========*/
+/**@ingroup gSearch
+ * Sink of search records.
+ * Records are JSON objects, written one per line. Several players,
+ * possibly from different threads, may share the same trace.
+ */
+struct SearchTrace
+{
+    /** Init constructor.
+     * @param[in] filename  file where records are written
+     * @throw std::runtime_error if the file cannot be opened.
+     */
+    explicit SearchTrace(std::string const& filename)
+        : m_file(filename)
+        {
+            if (!m_file) {
+                throw std::runtime_error("Cannot open " + filename);
+            }
+        }
+    /// Writes a record, and flushes it so that it can be followed live.
+    void write(std::string const& record) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_file << record << std::endl;
+    }
+private:
+    std::ofstream m_file;
+    std::mutex    m_mutex;
+};
+
+/**@ingroup gSearch
+ * Limits of a search for the next move.
+ * Null values stand for no limit.
+ */
+struct SearchLimits
+{
+    /// Init constructor.
+    SearchLimits(
+            size_t                    depth_ = 0,
+            std::chrono::milliseconds time_  = std::chrono::milliseconds(0),
+            size_t                    nodes_ = 0)
+        : depth(depth_), time(time_), nodes(nodes_) {}
+
+    size_t                    depth; ///< maximal depth searched
+    std::chrono::milliseconds time;  ///< time budget per move
+    size_t                    nodes; ///< maximal number of nodes searched per move
+};
+
+/**@ingroup gSearch
+ * Selective search of the alpha-beta players.
+ * - Late move reductions: the quiet moves, that neither make nor block
+ *   a threat, searched after the first \c lmr_moves ones are searched
+ *   one ply shallower, and two plies once twice as late; they are
+ *   searched again at full depth only if they turn out better than
+ *   alpha.
+ * - Threat extensions: the moves that make or block a threat are
+ *   searched one ply deeper, up to twice the depth of the iteration.
+ * Both are disabled by default.
+ */
+struct Selectivity
+{
+    /// Init constructor.
+    Selectivity() : lmr_moves(0), lmr_depth(3), extensions(false) {}
+
+    size_t lmr_moves;  ///< moves searched at full depth before reducing; 0 disables the reductions
+    size_t lmr_depth;  ///< minimal depth where moves are reduced
+    bool   extensions; ///< whether threat extensions are enabled
+
+    /** Settings that change the results of the searches, as salted
+     * into the keys of a \c PersistentCache.
+     * @return 0 when the search is not selective.
+     */
+    std::uint64_t settings() const {
+        return (lmr_moves ? std::uint64_t(lmr_moves) | std::uint64_t(lmr_depth) << 16 : 0)
+            | std::uint64_t(extensions) << 32;
+    }
+};
+
+/**@ingroup gPlayerAI
+ * Root class for AI player decision centres.
+ * The next move is chosen by iterative deepening: the actual search
+ * algorithm, \c search(), is run at increasing depths until a \c
+ * SearchLimits is reached, or until the game result is known. The best
+ * move from the last completed iteration is played.
+ *
+ * The search algorithms are expected to call \c must_stop() at each
+ * node, and to abort as soon as it returns \c true.
+ *
+ * Searches may be spread over several threads, either with helper
+ * threads that run along the main iterative deepening (see \c
+ * start_helpers()), or by splitting the work of each iteration (see \c
+ * in_parallel()).
+ *
+ * The effective branching factor reported is the ratio of the number of
+ * nodes searched by the main thread during the last two completed
+ * iterations.
+ *
+ * The search algorithms also report leaves, cutoffs, and transposition
+ * table probes (see \c count_leaf(), \c count_cutoff(), and \c
+ * count_tt_probe()). These counters are always maintained, per thread,
+ * and they are written with the timings of each iteration in a \c
+ * SearchTrace, if any, once per \c choose().
+ */
+struct AIPlayerDC : PlayerDC
+{
+    virtual Move choose(Game & g) const {
+        typedef std::chrono::steady_clock clock;
+        const clock::time_point start = clock::now();
+        Outcome o;
+        if (!end_pondering(g, o)) {
+            m_deadline = start + m_limits.time;
+            o = think(g);
+        }
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start);
+        const size_t nodes = total_nodes();
+        m_stats.moves ++;
+        m_stats.nodes += nodes;
+        m_stats.time  += elapsed;
+        m_last = Choice{o.best, o.score, o.depth, nodes, elapsed};
+        if (m_trace) {
+            m_trace->write(record(g, o.best, o.score, o.depth, elapsed, o.iterations));
+        }
+        if (std::ostream * log = g.log()) {
+            *log << algorithm() << " plays at " << g.board().coords(o.best) << " (" << o.score << ")"
+                << ", depth " << o.depth << ", " << nodes << " nodes";
+            if (o.ebf > 0) {
+                *log << ", ebf " << o.ebf;
+            }
+            *log << ", " << elapsed.count() / 1000 << "ms"
+                << ", " << size_t(nodes * 1e6 / std::max<double>(elapsed.count(), 1)) << " nps"
+                << (o.pondered ? ", ponder hit\n" : "\n");
+            if (o.score > +950)
+                *log << "You'll loose!\n";
+            else if (o.score < -950)
+                *log << "You should win...\n";
+        }
+        return o.best;
+    }
+
+    /** Searches, in the background, the position after the reply the
+     * player expects, see \c predict().
+     * When the adversary does play it, \c choose() takes over the
+     * search, with the time and the nodes already spent accounted in
+     * its limits: it may return at once. Otherwise, the search is
+     * abandoned, but what it has stored in the transposition table, if
+     * any, still helps.
+     * Nothing is done unless pondering is enabled, see \c
+     * set_pondering().
+     * @throw std::system_error if the thread cannot be started.
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    virtual void ponder(Game const& g) const {
+        stop_pondering();
+        Move reply;
+        if (!m_can_ponder || !predict(g, reply)) {
+            return;
+        }
+        PlayerId adv = m_id; adv ++;
+        m_ponder_state.reset(new GameState(g));
+        m_ponder_state->set(reply, adv);
+        if (m_ponder_state->is_a_winning_move_for(reply, adv)
+                || m_ponder_state->board().empty_squares().none()) {
+            return; // the game would be over
+        }
+        // The search plays on m_ponder_state: the position is saved for
+        // end_pondering() to compare with
+        m_ponder_stones = {{
+            m_ponder_state->board().stones(SquareValue::first),
+            m_ponder_state->board().stones(SquareValue::second)
+        }};
+        m_pondering.store(true, std::memory_order_relaxed);
+        m_deadline = std::chrono::steady_clock::now() + m_limits.time;
+        m_ponder_thread = std::thread([this]() {
+                try {
+                    m_ponder_outcome = this->think(*m_ponder_state);
+                } catch (...) {
+                    m_ponder_error = std::current_exception();
+                }
+            });
+    }
+    virtual void stop_pondering() const {
+        if (m_ponder_thread.joinable()) {
+            stop();
+            m_ponder_thread.join();
+        }
+        m_pondering.store(false, std::memory_order_relaxed);
+        m_ponder_error = nullptr;
+    }
+    /// Enables, or disables, the search during the turns of the adversary.
+    void set_pondering(bool on) { m_can_ponder = on; }
+
+    /// Statistics accumulated over all the moves chosen.
+    struct Stats {
+        Stats() : moves(0), nodes(0), time(0) {}
+        size_t                    moves;
+        size_t                    nodes;
+        std::chrono::microseconds time;
+    };
+    /// Statistics accumulated over all the moves chosen.
+    Stats const& stats() const { return m_stats; }
+
+    /// Result of a \c choose().
+    struct Choice {
+        Move                      move;
+        int                       score; ///< for the player who moves
+        size_t                    depth; ///< of the last iteration completed
+        size_t                    nodes;
+        std::chrono::microseconds time;
+    };
+    /// Result of the last \c choose().
+    Choice const& last_choice() const { return m_last; }
+
+    /** Sets where the searches are recorded.
+     * @param[in] trace  trace shared with other players, or \c nullptr
+     */
+    void trace_to(std::shared_ptr<SearchTrace> trace) { m_trace = std::move(trace); }
+    /// Name of the search algorithm, as recorded in traces.
+    virtual char const* algorithm() const = 0;
+
+    /** Requests the current search to stop as soon as possible.
+     * The best move from the last completed iteration is then returned
+     * by \c choose().
+     * @note May be called from another thread.
+     */
+    void stop() const noexcept {
+        m_stop.store(true, std::memory_order_relaxed);
+    }
+
+protected:
+    /** Init constructor.
+     * @param[in] limits  limits of the search for each move
+     * @param[in] id  player identifier
+     * @param[in] nb_threads  number of threads used by the search
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    AIPlayerDC(SearchLimits const& limits, PlayerId id, size_t nb_threads = 1)
+        : m_id(id)
+        , m_limits(limits)
+        , m_nb_threads(std::max<size_t>(nb_threads, 1))
+        , m_counters(new ThreadCounters[m_nb_threads])
+        , m_stop(false)
+        , m_can_abort(false)
+        , m_can_ponder(false)
+        , m_pondering(false)
+        {}
+
+    /** Searches the best move at a given depth.
+     * This is the main thread of the search, identified as thread 0.
+     * @param[in,out] g  Game current state.
+     * @param[in] depth  depth of the search, after the move chosen.
+     * @param[in,out] best  best move found by the previous iteration
+     * (\c no_move if none) on input, best move found on output.
+     * @return the evaluation of the best move.
+     * @note the result is ignored if the search has been aborted.
+     */
+    virtual int search(GameState & g, size_t depth, Move & best) const = 0;
+
+    /** Tries to prove the result of the position before searching it.
+     * When it succeeds, the move it gives is played without any search.
+     * By default, wins by continuous threats are looked for with \c
+     * vcf(): they are found far faster by this dedicated search than by
+     * the full width one.
+     * @param[in,out] g  Game current state.
+     * @param[out] best  move to play, when the result is proven
+     * @param[out] score  score of the move, when the result is proven
+     * @return whether the result is proven.
+     */
+    virtual bool prove(GameState & g, Move & best, int & score) const {
+        size_t plies = 0;
+        if (!vcf(g, best, plies)) {
+            return false;
+        }
+        score = 1001 - int(plies);
+        return true;
+    }
+
+    /** Predicts the reply of the adversary, to ponder on.
+     * By default, only the forced replies are predicted: the adversary
+     * completing a line, or blocking the only line of the player.
+     * @param[in] g  Game current state, the adversary to move.
+     * @param[out] reply  move predicted
+     * @return whether a move is predicted.
+     */
+    virtual bool predict(GameState const& g, Move & reply) const {
+        PlayerId adv = m_id; adv ++;
+        if (g.threats(adv).any()) {
+            reply = Move(g.threats(adv).first());
+            return true;
+        }
+        if (g.threats(m_id).count() == 1) {
+            reply = Move(g.threats(m_id).first());
+            return true;
+        }
+        return false;
+    }
+
+    /** Starts threads that help the main search.
+     * They run while the main thread runs the iterative deepening, and
+     * they shall end once \c stopped().
+     * They shall be identified from 1 to <tt>nb_threads()-1</tt>.
+     * By default, there is no helper.
+     * @param[in] g  Game current state, to be copied by each thread.
+     * @param[in] max_depth  maximal depth of the iterative deepening.
+     * @param[out] helpers  threads started.
+     */
+    virtual void start_helpers(GameState const& /*g*/, size_t /*max_depth*/, std::vector<std::thread> & /*helpers*/) const {}
+
+    /** Runs a search on all the threads.
+     * <tt>f(state, thread)</tt> is run on the current thread with \c g,
+     * and on <tt>nb_threads()-1</tt> new threads, with copies of \c g.
+     * The function returns once they are all done.
+     * @throw std::system_error if threads cannot be started.
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    template <class State, class F> void in_parallel(State & g, F f) const {
+        std::vector<State>       states(m_nb_threads-1, g);
+        std::vector<std::thread> threads;
+        try {
+            for (size_t t = 1; t < m_nb_threads ; ++t) {
+                threads.emplace_back(f, std::ref(states[t-1]), t);
+            }
+        } catch (...) {
+            join(threads);
+            throw;
+        }
+        f(g, 0);
+        for (auto & t : threads) t.join();
+    }
+
+    /** Accounts for a new node, and tells whether the search shall be
+     * aborted.
+     * The limits are checked only every few nodes in order to keep the
+     * check cheap.
+     * @param[in] thread  thread searching the node
+     * @param[in] period  number of nodes between two checks, smaller
+     * for the searches whose nodes are expensive
+     */
+    bool must_stop(size_t thread, size_t period = check_period) const noexcept {
+        // The counter is only written by its own thread
+        std::atomic<size_t> & counter = m_counters[thread].nodes;
+        const size_t nodes = counter.load(std::memory_order_relaxed) + 1;
+        counter.store(nodes, std::memory_order_relaxed);
+        if (nodes % period == 0 && m_can_abort.load(std::memory_order_relaxed)) {
+            check_limits();
+        }
+        return m_stop.load(std::memory_order_relaxed);
+    }
+    /// Accounts for a leaf evaluated.
+    void count_leaf(size_t thread) const noexcept {
+        m_counters[thread].leaves ++;
+    }
+    /** Accounts for a beta cutoff.
+     * @param[in] thread  thread searching the node
+     * @param[in] index  index of the move that causes the cutoff, in the
+     * order moves are searched
+     */
+    void count_cutoff(size_t thread, size_t index) const noexcept {
+        ThreadCounters & counters = m_counters[thread];
+        counters.cutoffs[std::min(index, counters.cutoffs.size()-1)] ++;
+    }
+    /// Accounts for a probe of a transposition table.
+    void count_tt_probe(size_t thread, bool hit) const noexcept {
+        ThreadCounters & counters = m_counters[thread];
+        counters.tt_probes ++;
+        counters.tt_hits += hit;
+    }
+
+    /** Looks for the moves forced by the threats on the board.
+     * - When the player to move can complete a line, she wins with her
+     *   next move.
+     * - Otherwise, when her adversary can complete a line, she has to
+     *   block it; and she loses if there are several lines to block.
+     * The known results are only reported when the remaining depth is
+     * enough to play them out, in order to keep the scores consistent
+     * with the ones the full search would find.
+     * @param[in] g  game state
+     * @param[in] p  player to move
+     * @param[in] depth  remaining depth of the search, 0 to only get
+     * the moves to search
+     * @param[out] score  result for \c p, when known
+     * @param[out] moves  moves worth searching, when the result is not
+     * known: the only square to block, or \c g.candidate_moves()
+     * @return whether the result is known.
+     * @throw None
+     */
+    static bool forced_moves(GameState const& g, PlayerId p, size_t depth, int & score, Mask & moves) noexcept {
+        PlayerId adv = p; adv ++;
+        if (depth >= 1 && g.threats(p).any()) {
+            score = 1001 - int(depth);
+            return true;
+        }
+        Mask const& blocks = g.threats(adv);
+        if (blocks.none()) {
+            moves = g.candidate_moves();
+        } else if (depth >= 2 && blocks.count() >= 2) {
+            score = -1002 + int(depth);
+            return true;
+        } else {
+            moves = blocks;
+        }
+        return false;
+    }
+
+    /** Runs a function on the game state, specialised for its geometry.
+     * The most common geometries are known at compile time: \c f is then
+     * run on a \c FixedGameState copy of \c g, whose hot paths are
+     * faster. Otherwise, it is run on \c g itself.
+     * @param[in,out] g  game state
+     * @param[in] f  functor with a <tt>int operator()(State &)</tt>
+     * member template, for \c GameState and any \c FixedGameState
+     * @return what \c f returns.
+     * @throw Whatever f may throw, and std::bad_alloc if memory is
+     * exhausted.
+     * @note The moves \c f plays on a copy are not played on \c g.
+     */
+    template <class F> static int with_fixed_geometry(GameState & g, F const& f) {
+        int res;
+        if (run_as<FixedGameState< 3, 3,3>>(g, f, res)
+                || run_as<FixedGameState< 4, 4,4>>(g, f, res)
+                || run_as<FixedGameState< 8, 8,4>>(g, f, res)
+                || run_as<FixedGameState<15,15,5>>(g, f, res)) {
+            return res;
+        }
+        return f(g);
+    }
+
+    /// Tells whether the search is being aborted.
+    bool stopped() const noexcept {
+        return m_stop.load(std::memory_order_relaxed);
+    }
+    /// Number of threads used by the search.
+    size_t nb_threads() const { return m_nb_threads; }
+    /// Limits of the search for each move.
+    SearchLimits const& limits() const { return m_limits; }
+
+    const PlayerId m_id;
+
+private:
+    template <class State, class F> static bool run_as(GameState & g, F const& f, int & res) {
+        if (!State::match(g)) {
+            return false;
+        }
+        State state(g);
+        res = f(state);
+        return true;
+    }
+
+    /** Counters of a thread, alone on their cache line.
+     * Only \c nodes is read while the search runs; the other counters
+     * are read once the threads are joined.
+     */
+    struct ThreadCounters {
+        ThreadCounters() { reset(); }
+        void reset() {
+            nodes.store(0, std::memory_order_relaxed);
+            leaves = tt_probes = tt_hits = 0;
+            cutoffs.fill(0);
+        }
+        std::atomic<size_t>   nodes;
+        size_t                leaves;
+        size_t                tt_probes;
+        size_t                tt_hits;
+        /// Cutoffs by the 1st, 2nd, 3rd, and any later move
+        std::array<size_t, 4> cutoffs;
+    };
+    static_assert(sizeof(ThreadCounters) % 64 == 0, "ThreadCounters shall fill cache lines");
+
+    /// Results of an iteration of the iterative deepening.
+    struct Iteration {
+        size_t                    depth;
+        size_t                    nodes; ///< searched by the main thread
+        int                       score;
+        Move                      move;
+        std::chrono::microseconds time;
+        bool                      aborted;
+    };
+
+    /// Results of \c think().
+    struct Outcome {
+        Outcome() : best(no_move), score(0), depth(0), ebf(0), pondered(false) {}
+        Move                   best;
+        int                    score;
+        size_t                 depth; ///< of the last iteration completed
+        double                 ebf;   ///< effective branching factor, 0 if unknown
+        std::vector<Iteration> iterations;
+        bool                   pondered; ///< found while pondering
+    };
+
+    /** Searches the best move: \c prove(), or else the iterative
+     * deepening of \c search().
+     * The counters are reset, but the deadline shall be set by the
+     * caller.
+     */
+    Outcome think(GameState & g) const {
+        typedef std::chrono::steady_clock clock;
+        for (size_t t=0; t!=m_nb_threads ; ++t) {
+            m_counters[t].reset();
+        }
+        m_can_abort.store(false, std::memory_order_relaxed);
+        m_stop.store(false, std::memory_order_relaxed);
+
+        // There is no need to search deeper than the number of moves left
+        const size_t nb_free   = g.board().empty_squares().count();
+        const size_t max_depth = nb_free == 0      ? 0
+            : m_limits.depth == 0                  ? nb_free-1
+            :                  std::min(m_limits.depth, nb_free-1);
+
+        Outcome o;
+        if (nb_free == 0) {
+            return o; // nothing to play
+        }
+        size_t base_depth = 0, base_nodes = 0; // first iteration measured for the ebf
+        if (!prove(g, o.best, o.score)) {
+            // The search starts afresh, whatever prove() has done
+            m_can_abort.store(false, std::memory_order_relaxed);
+            m_stop.store(false, std::memory_order_relaxed);
+            std::vector<std::thread> helpers;
+            try {
+                start_helpers(g, max_depth, helpers);
+            } catch (...) {
+                join(helpers);
+                throw;
+            }
+
+            for (size_t depth = 0; depth <= max_depth ; ++depth) {
+                Move crt_best = o.best;
+                const size_t nodes_before = main_nodes();
+                const clock::time_point iteration_start = clock::now();
+                const int eval = search(g, depth, crt_best);
+                const size_t nodes = main_nodes() - nodes_before;
+                o.iterations.push_back(Iteration{depth, nodes, eval, crt_best,
+                        std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - iteration_start),
+                        m_stop.load(std::memory_order_relaxed)});
+                if (o.iterations.back().aborted) {
+                    break; // incomplete iteration => ignored
+                }
+                // The shallow iterations, nearly free once the transposition
+                // table is filled, would blow up the ratio: the ebf is the
+                // geometric mean over the iterations that searched enough.
+                if (nodes >= ebf_min_nodes) {
+                    if (base_nodes == 0) {
+                        base_depth = depth;
+                        base_nodes = nodes;
+                    } else {
+                        o.ebf = std::pow(double(nodes) / double(base_nodes), 1. / double(depth - base_depth));
+                    }
+                }
+                o.best     = crt_best;
+                o.score    = eval;
+                o.depth    = depth;
+                // The first iteration is always completed, in order to have
+                // a move to play
+                m_can_abort.store(true, std::memory_order_relaxed);
+                if (std::abs(o.score) > 900) {
+                    break; // the game result is known
+                }
+            }
+            join(helpers);
+        }
+        return o;
+    }
+
+    /** Ends the pondering, if any.
+     * When the position is the one pondered on, the search goes on
+     * within the limits of the player, and its result is taken.
+     * @param[in] g  Game current state, the player to move.
+     * @param[out] o  result of the search pondered, if taken.
+     * @return whether the result of the search pondered is taken.
+     * @throw Whatever the search pondered has thrown.
+     */
+    bool end_pondering(GameState const& g, Outcome & o) const {
+        if (!m_ponder_thread.joinable()) {
+            return false;
+        }
+        const bool hit
+            =  g.board().stones(SquareValue::first)  == m_ponder_stones[0]
+            && g.board().stones(SquareValue::second) == m_ponder_stones[1];
+        if (hit) {
+            m_pondering.store(false, std::memory_order_relaxed); // the limits now apply
+        } else {
+            stop();
+        }
+        m_ponder_thread.join();
+        m_pondering.store(false, std::memory_order_relaxed);
+        if (m_ponder_error) {
+            std::exception_ptr error = m_ponder_error;
+            m_ponder_error = nullptr;
+            std::rethrow_exception(error);
+        }
+        if (!hit) {
+            return false;
+        }
+        o = std::move(m_ponder_outcome);
+        o.pondered = true;
+        return true;
+    }
+
+    /// Builds the JSON record of a \c choose().
+    std::string record(Game const& g, Move move, int score, size_t depth,
+            std::chrono::microseconds time, std::vector<Iteration> const& iterations) const
+    {
+        size_t leaves = 0, tt_probes = 0, tt_hits = 0;
+        std::array<size_t, 4> cutoffs = {{0, 0, 0, 0}};
+        for (size_t t=0; t!=m_nb_threads ; ++t) {
+            ThreadCounters const& c = m_counters[t];
+            leaves    += c.leaves;
+            tt_probes += c.tt_probes;
+            tt_hits   += c.tt_hits;
+            for (size_t k=0; k!=cutoffs.size() ; ++k) cutoffs[k] += c.cutoffs[k];
+        }
+        auto json = [&g](Move m) -> std::string {
+            if (m == no_move) {
+                return "null";
+            }
+            const Coords c = g.board().coords(m);
+            return "[" + std::to_string(std::get<0>(c)) + "," + std::to_string(std::get<1>(c)) + "]";
+        };
+        std::ostringstream os;
+        os << "{\"algorithm\":\"" << algorithm() << "\""
+            << ",\"player\":" << size_t(m_id)
+            << ",\"moves\":" << g.nb_moves()
+            << ",\"move\":" << json(move)
+            << ",\"score\":" << score
+            << ",\"depth\":" << depth
+            << ",\"threads\":" << m_nb_threads
+            << ",\"time_us\":" << time.count()
+            << ",\"nodes\":" << total_nodes()
+            << ",\"leaves\":" << leaves
+            << ",\"cutoffs\":[" << cutoffs[0] << "," << cutoffs[1] << "," << cutoffs[2] << "," << cutoffs[3] << "]"
+            << ",\"tt_probes\":" << tt_probes
+            << ",\"tt_hits\":" << tt_hits
+            << ",\"iterations\":[";
+        for (size_t k=0; k!=iterations.size() ; ++k) {
+            Iteration const& it = iterations[k];
+            os << (k ? "," : "")
+                << "{\"depth\":" << it.depth
+                << ",\"nodes\":" << it.nodes
+                << ",\"time_us\":" << it.time.count()
+                << ",\"score\":" << it.score
+                << ",\"move\":" << json(it.move)
+                << ",\"aborted\":" << (it.aborted ? "true" : "false")
+                << "}";
+        }
+        os << "]}";
+        return os.str();
+    }
+
+    size_t main_nodes() const {
+        return m_counters[0].nodes.load(std::memory_order_relaxed);
+    }
+    size_t total_nodes() const {
+        size_t nodes = 0;
+        for (size_t t=0; t!=m_nb_threads ; ++t)
+            nodes += m_counters[t].nodes.load(std::memory_order_relaxed);
+        return nodes;
+    }
+    void check_limits() const noexcept {
+        if (m_pondering.load(std::memory_order_relaxed)) {
+            return; // till the adversary plays
+        }
+        if ((m_limits.nodes && total_nodes() >= m_limits.nodes)
+                || (m_limits.time.count() && std::chrono::steady_clock::now() >= m_deadline)) {
+            stop();
+        }
+    }
+    void join(std::vector<std::thread> & threads) const {
+        stop();
+        for (auto & t : threads) t.join();
+        threads.clear();
+    }
+
+    /** Searches a victory by continuous threats for the player to move.
+     * Each of her moves shall make a new threat, so that her adversary
+     * has no choice but to block it, until she makes two threats at
+     * once. Only her moves are searched: the tree is narrow enough to be
+     * searched far deeper than the full width search. The shortest
+     * sequence is searched first.
+     * The search is bounded by \c vcf_max_moves and \c vcf_max_nodes.
+     * @param[in,out] g  Game current state.
+     * @param[out] move  first move of the winning sequence
+     * @param[out] plies  length of the winning sequence
+     * @return whether a winning sequence has been found.
+     * @throw None
+     */
+    bool vcf(GameState & g, Move & move, size_t & plies) const noexcept {
+        // Iterative deepening, so that the shortest sequence is found
+        size_t nodes_left = vcf_max_nodes;
+        for (size_t moves = 0; moves <= vcf_max_moves && nodes_left ; ++moves) {
+            if (vcf_attack(g, m_id, moves, nodes_left, plies, &move)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    bool vcf_attack(GameState & g, PlayerId att, size_t moves_left, size_t & nodes_left, size_t & plies, Move * first) const noexcept {
+        PlayerId def = att; def ++;
+        if (g.threats(att).any()) {
+            if (first) *first = Move(g.threats(att).first());
+            plies = 1;
+            return true;
+        }
+        // A threat of the adversary has to be blocked by the next threat
+        if (moves_left == 0 || g.threats(def).count() >= 2) {
+            return false;
+        }
+        const Mask moves = g.threats(def).any() ? g.threats(def) : g.candidate_moves();
+        bool found = false;
+        moves.for_each_bit([&](size_t i) -> bool {
+                if (nodes_left == 0 || must_stop(0)) {
+                    return false; // abort loop
+                }
+                --nodes_left;
+                const Move where = Move(i);
+                g.set(where, att);
+                Mask const& threats = g.threats(att);
+                if (threats.any() && g.threats(def).none()) {
+                    if (threats.count() >= 2) {
+                        plies = 3;
+                        found = true;
+                    } else {
+                        const Move block = Move(threats.first());
+                        g.set(block, def);
+                        size_t sub = 0;
+                        found = vcf_attack(g, att, moves_left-1, nodes_left, sub, nullptr);
+                        plies = 2 + sub;
+                        g.reset(block);
+                    }
+                }
+                g.reset(where);
+                if (found && first) *first = where;
+                return !found;
+            });
+        return found;
+    }
+
+    /// Number of nodes between two checks of the limits.
+    static const size_t check_period = 1024;
+    /// Minimal number of nodes of an iteration accounted in the ebf.
+    static const size_t ebf_min_nodes = 64;
+    /// Maximal number of threats in a row searched by \c vcf().
+    static const size_t vcf_max_moves = 10;
+    /// Maximal number of moves tried by \c vcf().
+    static const size_t vcf_max_nodes = 1 << 14;
+
+    const SearchLimits                            m_limits;
+    const size_t                                  m_nb_threads;
+    std::unique_ptr<ThreadCounters[]>             m_counters;
+    mutable std::atomic<bool>                     m_stop;
+    mutable std::atomic<bool>                     m_can_abort;
+    mutable std::chrono::steady_clock::time_point m_deadline;
+    mutable Stats                                 m_stats;
+    mutable Choice                                m_last;
+    std::shared_ptr<SearchTrace>                  m_trace;
+    /**@name Pondering */
+    //@{
+    bool                                          m_can_ponder;
+    mutable std::atomic<bool>                     m_pondering; ///< the limits do not apply yet
+    mutable std::thread                           m_ponder_thread;
+    mutable std::unique_ptr<GameState>            m_ponder_state;
+    mutable std::array<Mask, 2>                   m_ponder_stones; ///< position pondered on
+    mutable Outcome                               m_ponder_outcome;
+    mutable std::exception_ptr                    m_ponder_error;
+    //@}
+};
+
+/*===============================[ AIPlayerDC : negamax ]====================*/
+/**@ingroup gPlayerAI
+ * Player decision centre implemented with the negamax algorithm.
+ * With several threads, the moves of the root are shared among the
+ * threads: each thread takes the next move not yet searched.
+ * @see http://en.wikipedia.org/wiki/Negamax
+ */
+struct NegaMaxPlayerDC : AIPlayerDC
+{
+    /** Init constructor.
+     * @param[in] limits  limits of the search for each move
+     * @param[in] id  player identifier
+     * @param[in] nb_threads  number of threads used by the search
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    NegaMaxPlayerDC(SearchLimits const& limits, PlayerId id, size_t nb_threads = 1)
+        : AIPlayerDC(limits, id, nb_threads) {}
+
+    virtual char const* algorithm() const { return "negamax"; }
+
+private:
+    virtual int search(GameState & g, size_t depth, Move & best) const {
+        return with_fixed_geometry(g, Search{*this, depth, best});
+    }
+
+    /// Runs \c search_in() on any kind of state.
+    struct Search {
+        template <class State> int operator()(State & g) const {
+            return self.search_in(g, depth, best);
+        }
+        NegaMaxPlayerDC const& self;
+        size_t                 depth;
+        Move                 & best;
+    };
+
+    template <class State> int search_in(State & g, size_t depth, Move & best) const {
+        // Moves equivalent by symmetry are searched once
+        const unsigned stabilizer = g.stabilizer();
+        int unused;
+        Mask candidates;
+        forced_moves(g, m_id, 0, unused, candidates);
+        std::vector<Move> moves;
+        candidates.for_each_bit([&](size_t i) -> bool {
+                if (g.is_canonical_move(i, stabilizer)) {
+                    moves.push_back(Move(i));
+                }
+                return true;
+            });
+        std::vector<int>    evals(moves.size());
+        std::atomic<size_t> next(0);
+        in_parallel(g, [&](State & state, size_t thread) {
+                for (size_t i ; (i = next++) < moves.size() && !this->stopped() ; ) {
+                    state.set(moves[i],this->m_id); // push the current move
+                    evals[i] = - this->negamax(state, thread, depth, this->m_id, moves[i]);
+                    state.reset(moves[i]);   // pop the move
+                }
+            });
+        // The first best move is kept, whatever the thread that found it
+        int max = std::numeric_limits<int>::min();
+        for (size_t i=0; i!=moves.size() ; ++i) {
+            if (evals[i] > max) {
+                max = evals[i];
+                best = moves[i];
+            }
+        }
+        return max;
+    }
+
+    template <class State>
+    int negamax(State & g, size_t thread, size_t depth, PlayerId who, Move current) const noexcept
+    {
+#if DEBUG_AI_LEVEL > 0
+        const std::string indent (4*(6-depth), ' ');
+        std::cout << indent << "negamax(" << g.board().coords(current) << ", " <<depth<<", "<<who
+            // << ", alpha="<<alpha << ", beta= "<<beta
+            << ")\n";
+#if DEBUG_AI_LEVEL > 1
+        std::cout << g.board();
+#endif
+#endif
+        if (must_stop(thread)) {
+            return 0; // aborted => ignored
+        }
+
+        // terminal conditions => heuristic
+        if (g.is_a_winning_move_for(current, who)) {
+            // const int found = (1000) * (who==this->m_id ? 1 : -1);
+            const int found = -(1000) + depth;
+#if DEBUG_AI_LEVEL > 0
+            std::cout << indent << "  "<<g.board().coords(current)<<"-> ... winning move => "<<found<<"("<<who<< ")\n" ;
+#endif
+            return found;
+        } else if (depth == 0) {
+#if DEBUG_AI_LEVEL > 0
+            std::cout << indent << "  "<<g.board().coords(current)<<"-> ... exploration leaf => "<<-g.evaluate(who)<<"("<<who<< ")\n" ;
+#endif
+            count_leaf(thread);
+            // evaluated for the player to move, i.e. the adversary
+            return -g.evaluate(who);
+        }
+
+        // forced moves => known result, or the only move to search
+        PlayerId adv = who; adv ++;
+        int forced_score;
+        Mask moves;
+        if (forced_moves(g, adv, depth, forced_score, moves)) {
+            return forced_score;
+        }
+
+        // else loop on all children nodes
+        int max = std::numeric_limits<int>::min();
+#if DEBUG_AI_LEVEL > 0
+        Move best=no_move;
+#endif
+        moves.for_each_bit(
+            [&](size_t i) -> bool {
+                const Move child_node = Move(i);
+                g.set(child_node,adv); // push the current move
+                int eval = - this->negamax(g, thread, depth-1, adv, child_node);
+                g.reset(child_node);   // pop the move
+                if (eval > max) {
+                    max = eval;
+#if DEBUG_AI_LEVEL > 0
+                    best= child_node;
+#endif
+                }
+                return !this->stopped(); // continue
+            });
+        if (max == std::numeric_limits<int>::min()) { // no child node
+            max = 0;
+        }
+#if DEBUG_AI_LEVEL > 0
+        std::cout << indent << "  "<<g.board().coords(current)<<"-> best move="<<best<<" => "<<max<<"("<<who<< ")\n" ;
+#endif
+        return max;
+    }
+
+};
+
+
+/*===============================[ AIPlayerDC : negamax alpha-beta ]=========*/
+/**@ingroup gPlayerAI
+ * Player decision centre implemented with the negamax with alplha/beta algorithm.
+ * The positions already searched are remembered in a \c
+ * TranspositionTable, which is kept from one move to the next. The
+ * moves are searched in the order given by \c MoveOrdering.
+ *
+ * With several threads, the search is a Lazy SMP: helper threads run
+ * their own iterative deepening on their own copy of the game, starting
+ * at different depths. They share nothing but the transposition table,
+ * which the main thread takes advantage of.
+ * @see http://en.wikipedia.org/wiki/Alpha-beta_pruning
+ */
+struct NegaMaxPlayerAlphaBetaDC : AIPlayerDC
+{
+    /** Init constructor.
+     * @param[in] limits  limits of the search for each move
+     * @param[in] id  player identifier
+     * @param[in] tt_size_in_MB  size of the transposition table
+     * @param[in] nb_threads  number of threads used by the search
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    NegaMaxPlayerAlphaBetaDC(SearchLimits const& limits, PlayerId id, size_t tt_size_in_MB = 16, size_t nb_threads = 1)
+        : AIPlayerDC(limits, id, nb_threads)
+        , m_pvs(false)
+        , m_tt(tt_size_in_MB)
+        , m_orderings(this->nb_threads())
+        , m_previous_scores(this->nb_threads(), 0)
+        , m_iteration_depths(this->nb_threads(), 0)
+        , m_cache_salts(this->nb_threads(), 0)
+        {}
+
+    virtual char const* algorithm() const { return m_pvs ? "negascout" : "alphabeta"; }
+
+    /** Sets the persistent cache shared with other players and processes.
+     * The positions missing from the transposition table are looked up
+     * in the cache; the results are written to the cache when it is
+     * writable.
+     * @param[in] cache  cache, or \c nullptr
+     */
+    void use_cache(std::shared_ptr<PersistentCache> cache) { m_cache = std::move(cache); }
+    /** Sets the tablebase of the exact values of the positions.
+     * It is used for the games whose board it matches: the moves are
+     * then chosen by looking up the positions they lead to, and the
+     * searches look up the positions instead of searching them.
+     * @param[in] tablebase  table, or \c nullptr
+     */
+    void use_tablebase(std::shared_ptr<const Tablebase> tablebase) { m_tablebase = std::move(tablebase); }
+    /// Sets the selective search settings.
+    void set_selectivity(Selectivity const& selectivity) { m_selectivity = selectivity; }
+
+protected:
+    /** Init constructor for variations of the algorithm.
+     * @param[in] pvs  whether the principal variation search is used
+     */
+    NegaMaxPlayerAlphaBetaDC(SearchLimits const& limits, PlayerId id, size_t tt_size_in_MB, size_t nb_threads, bool pvs)
+        : AIPlayerDC(limits, id, nb_threads)
+        , m_pvs(pvs)
+        , m_tt(tt_size_in_MB)
+        , m_orderings(this->nb_threads())
+        , m_previous_scores(this->nb_threads(), 0)
+        , m_iteration_depths(this->nb_threads(), 0)
+        , m_cache_salts(this->nb_threads(), 0)
+        {}
+
+    /** Chooses the move from the tablebase, when it matches the board.
+     * The shortest win is preferred, then the draw, then the longest
+     * loss. Wins are scored as \c AIPlayerDC::vcf() does, and losses
+     * likewise.
+     * Otherwise, wins by continuous threats are looked for, see \c
+     * AIPlayerDC::prove().
+     */
+    virtual bool prove(GameState & g, Move & best, int & score) const {
+        if (!m_tablebase || !m_tablebase->match(g)) {
+            return AIPlayerDC::prove(g, best, score);
+        }
+        int max = std::numeric_limits<int>::min();
+        g.board().empty_squares().for_each_bit([&](size_t i) -> bool {
+                const Move where = Move(i);
+                int eval;
+                if (g.is_a_winning_move_for(where, m_id)) {
+                    eval = 1000;
+                } else {
+                    g.set(where, m_id);
+                    const Tablebase::Entry e = m_tablebase->probe(g);
+                    g.reset(where);
+                    if (e.value == Tablebase::Value::unknown) {
+                        max = std::numeric_limits<int>::min();
+                        return false; // not a position of the game
+                    }
+                    // Scored as vcf() does: 1001 - plies till the end
+                    const int known = 1000 - int(e.distance);
+                    eval = e.value == Tablebase::Value::loss ?  known
+                        :  e.value == Tablebase::Value::win  ? -known
+                        :                                       0;
+                }
+                if (eval > max) {
+                    max  = eval;
+                    best = where;
+                }
+                return true;
+            });
+        if (max == std::numeric_limits<int>::min()) {
+            return AIPlayerDC::prove(g, best, score);
+        }
+        score = max;
+        return true;
+    }
+
+private:
+    /** Score of an entry of the tablebase, as the search would find it.
+     * Wins and losses found at \c depth from the leaves, \c distance
+     * plies ahead, are scored as \c TranspositionTable::score_to_tt()
+     * expects.
+     */
+    static int tablebase_score(Tablebase::Entry const& e, size_t depth) {
+        const int known = 1000 + int(e.distance) - int(depth);
+        return e.value == Tablebase::Value::win  ?  known
+            :  e.value == Tablebase::Value::loss ? -known
+            :                                       0;
+    }
+
+    virtual int search(GameState & g, size_t depth, Move & best) const {
+#if DEBUG_AI_LEVEL > 0
+        std::cout << "\n";
+#endif
+        if (depth == 0) { // first iteration
+            m_orderings[0].new_search(g.board());
+        }
+        return with_fixed_geometry(g, Iterate{*this, 0, depth, best});
+    }
+
+    virtual void start_helpers(GameState const& g, size_t max_depth, std::vector<std::thread> & helpers) const {
+        for (size_t t = 1; t < nb_threads() ; ++t) {
+            GameState state = g;
+            helpers.emplace_back([this, state, t, max_depth]() mutable {
+                    with_fixed_geometry(state, Help{*this, t, max_depth});
+                });
+        }
+    }
+
+    /// The reply predicted is the best move stored for the position, if any.
+    virtual bool predict(GameState const& g, Move & reply) const {
+        if (AIPlayerDC::predict(g, reply)) {
+            return true;
+        }
+        typedef TranspositionTable TT;
+        const size_t sym = g.canonical_symmetry();
+        TT::Entry e;
+        if (!m_tt.probe(g.hash(sym), e) || e.move == no_move) {
+            return false;
+        }
+        const Move m = Move(g.symmetries().preimage(sym, e.move));
+        if (!g.board().empty_squares().test(m)) {
+            return false; // hash collision
+        }
+        reply = m;
+        return true;
+    }
+
+    /// Runs \c iterate() on any kind of state.
+    struct Iterate {
+        template <class State> int operator()(State & g) const {
+            return self.iterate(g, thread, depth, best);
+        }
+        NegaMaxPlayerAlphaBetaDC const& self;
+        size_t                          thread;
+        size_t                          depth;
+        Move                          & best;
+    };
+    /// Runs \c help() on any kind of state.
+    struct Help {
+        template <class State> int operator()(State & g) const {
+            self.help(g, thread, max_depth);
+            return 0;
+        }
+        NegaMaxPlayerAlphaBetaDC const& self;
+        size_t                          thread;
+        size_t                          max_depth;
+    };
+
+    /** Iterative deepening of a helper thread.
+     * Odd threads start one ply deeper than even threads, so that they
+     * don't all search the same tree at the same time.
+     */
+    template <class State>
+    void help(State & g, size_t thread, size_t max_depth) const noexcept {
+        m_orderings[thread].new_search(g.board());
+        for (size_t depth = 1 + thread % 2; depth <= max_depth && !stopped() ; ++depth) {
+            Move best = no_move;
+            if (std::abs(iterate(g, thread, depth, best)) > 900) {
+                break; // the game result is known
+            }
+        }
+    }
+
+    /** Iteration of the iterative deepening.
+     * @see \c AIPlayerDC::search()
+     */
+    template <class State>
+    int iterate(State & g, size_t thread, size_t depth, Move & best) const {
+        m_iteration_depths[thread] = depth;
+        m_cache_salts[thread] = m_cache ? PersistentCache::salt(g, m_selectivity.settings()) : 0;
+        int & previous_score = m_previous_scores[thread];
+        if (!m_pvs || depth == 0) {
+            return previous_score = search_root(g, thread, depth, best, -1000, +1000);
+        }
+        // Aspiration window around the score of the previous iteration,
+        // widened on the failing side when the score falls outside.
+        int alpha = std::max(previous_score - aspiration_delta, -1000);
+        int beta  = std::min(previous_score + aspiration_delta, +1000);
+        for (;;) {
+            Move crt_best = best;
+            const int eval = search_root(g, thread, depth, crt_best, alpha, beta);
+            if (stopped()) {
+                return eval;
+            }
+            if (eval <= alpha && alpha > -1000) {
+                alpha = -1000;
+            } else if (eval >= beta && beta < +1000) {
+                beta = +1000;
+            } else {
+                best = crt_best;
+                return previous_score = eval;
+            }
+        }
+    }
+
+    template <class State>
+    int search_root(State & g, size_t thread, size_t depth, Move & best, int alpha, int beta) const {
+        // The best move from the previous iteration is searched first
+        int unused;
+        Mask candidates;
+        forced_moves(g, m_id, 0, unused, candidates);
+        MoveList moves;
+        m_orderings[thread].generate(g.board(), candidates, 0, m_id, best, moves);
+        // Moves equivalent by symmetry are searched once
+        const unsigned stabilizer = g.stabilizer();
+        int max = std::numeric_limits<int>::min();
+        for (Move m ; moves.next(m) ; ) {
+            if (stabilizer && !g.is_canonical_move(m, stabilizer)) {
+                continue;
+            }
+            const bool first = max == std::numeric_limits<int>::min();
+            int eval = search_move(g, thread, m, this->m_id, depth, 1, alpha, beta, first);
+            if (this->stopped()) {
+                break; // abort loop
+            }
+            if (eval > max) {
+                max = eval;
+                best = m;
+            }
+            if (eval > alpha) {
+                alpha = eval;
+                if (alpha >= beta) {
+                    break; // abort loop
+                }
+            }
+        }
+        return max;
+    }
+
+    /** Searches the position after a move.
+     * With the principal variation search, all the moves but the first
+     * one are searched with a null window, which only tells whether they
+     * are better than \c alpha. Only the moves that are better are
+     * searched again with the full window.
+     * @param[in,out] g  Game current state.
+     * @param[in] thread  thread searching the move
+     * @param[in] where  move searched
+     * @param[in] who  player who plays the move
+     * @param[in] depth  depth of the search after the move
+     * @param[in] ply  distance of the position after the move to the root
+     * @param[in] alpha, beta  window of the search, for \c who
+     * @param[in] first  whether this is the first move searched
+     * @param[in] reduction  plies the move is first searched shallower,
+     * with a null window, see \c Selectivity
+     * @return the score of the move, for \c who.
+     */
+    template <class State>
+    int search_move(State & g, size_t thread, Move where, PlayerId who, size_t depth, size_t ply,
+            int alpha, int beta, bool first, size_t reduction = 0) const noexcept
+    {
+        g.set(where,who); // push the current move
+        int eval = 0;
+        bool full = true;
+        if (reduction) {
+            eval = - this->negamax(g, thread, depth-reduction, ply, who, where, -alpha-1, -alpha);
+            full = eval > alpha && !stopped();
+        }
+        if (!full) {
+            // the reduced search is enough
+        } else if (m_pvs && !first) {
+            eval = - this->negamax(g, thread, depth, ply, who, where, -alpha-1, -alpha);
+            if (eval > alpha && eval < beta && !stopped()) {
+                eval = - this->negamax(g, thread, depth, ply, who, where, -beta, -alpha);
+            }
+        } else {
+            eval = - this->negamax(g, thread, depth, ply, who, where, -beta, -alpha);
+        }
+        g.reset(where);   // pop the move
+        return eval;
+    }
+
+    template <class State>
+    int negamax(State & g, size_t thread, size_t depth, size_t ply, PlayerId who, Move current, int alpha, int beta) const noexcept
+    {
+#if DEBUG_AI_LEVEL > 0
+        const std::string indent (4*ply, ' ');
+        std::cout << indent << "negamax(" << g.board().coords(current) << ", " <<depth<<", "<<who
+            // << ", alpha="<<alpha << ", beta= "<<beta
+            << ")\n";
+#if DEBUG_AI_LEVEL > 1
+        std::cout << g.board();
+#endif
+#endif
+        if (must_stop(thread)) {
+            return 0; // aborted => ignored
+        }
+
+        // terminal conditions => heuristic
+        if (g.is_a_winning_move_for(current, who)) {
+            // const int found = (1000) * (who==this->m_id ? 1 : -1);
+            const int found = -(1000) + depth;
+            // todo: find a way to shorten the suffering! (+depth is not
+            // enough)
+#if DEBUG_AI_LEVEL > 0
+            std::cout << indent << "  "<<g.board().coords(current)<<"-> ... winning move => "<<found<<"("<<who<< ")\n" ;
+#endif
+            return found;
+        } else if (m_tablebase && m_tablebase->match(g)) {
+            // tablebase => exact result, whatever the depth
+            const Tablebase::Entry e = m_tablebase->probe(g);
+            if (e.value != Tablebase::Value::unknown) {
+                count_leaf(thread);
+                return tablebase_score(e, depth);
+            }
+        }
+        if (depth == 0) {
+#if DEBUG_AI_LEVEL > 0
+            std::cout << indent << "  "<<g.board().coords(current)<<"-> ... exploration leaf => "<<-g.evaluate(who)<<"("<<who<< ")\n" ;
+#endif
+            count_leaf(thread);
+            // evaluated for the player to move, i.e. the adversary
+            return -g.evaluate(who);
+        }
+
+        // forced moves => known result, or the only move to search
+        PlayerId adv = who; adv ++;
+        int forced_score;
+        Mask candidates;
+        if (forced_moves(g, adv, depth, forced_score, candidates)) {
+            return forced_score;
+        }
+
+        // transposition table => known result, or at least the best move
+        // to try first
+        // Positions are stored in their canonical form, along with the
+        // image of their best move
+        typedef TranspositionTable TT;
+        const bool use_tt = depth >= tt_min_depth;
+        const size_t sym  = use_tt ? g.canonical_symmetry() : 0;
+        const std::uint64_t key = g.hash(sym);
+        Move hash_move = no_move;
+        TT::Entry e;
+        bool tt_hit = use_tt && m_tt.probe(key, e);
+        if (use_tt) {
+            count_tt_probe(thread, tt_hit);
+        }
+        // The cache is looked up when the table does not have enough
+        const bool use_cache = m_cache && depth >= cache_min_depth;
+        const std::uint64_t cache_key = use_cache ? key ^ m_cache_salts[thread] : 0;
+        TT::Entry cached;
+        if (use_cache && (!tt_hit || e.depth < depth)
+                && m_cache->table().probe(cache_key, cached)
+                && (!tt_hit || cached.depth > e.depth)) {
+            e = cached;
+            tt_hit = true;
+        }
+        if (tt_hit) {
+            if (e.depth >= depth) {
+                const int score = TT::score_from_tt(e.score, depth);
+                if (e.bound == TT::Bound::exact
+                        || (e.bound == TT::Bound::lower && score >= beta)
+                        || (e.bound == TT::Bound::upper && score <= alpha)) {
+                    return score;
+                }
+            }
+            if (e.move != no_move) {
+                hash_move = Move(g.symmetries().preimage(sym, e.move));
+            }
+        }
+        const int alpha_orig = alpha;
+
+        // else loop on all children nodes
+        int max = std::numeric_limits<int>::min();
+        Move best = no_move;
+        size_t nb_searched = 0;
+        // Near the root, moves equivalent by symmetry are searched once
+        const unsigned stabilizer = ply < symmetry_max_ply ? g.stabilizer() : 0;
+        const bool   selective = m_selectivity.lmr_moves || m_selectivity.extensions;
+        const size_t extend    = m_selectivity.extensions && ply < 2*m_iteration_depths[thread] ? 1 : 0;
+        auto visit = [&](Move m) -> bool {
+            if (stabilizer && !g.is_canonical_move(m, stabilizer)) {
+                return true; // continue
+            }
+            const bool first = max == std::numeric_limits<int>::min();
+            // Selective search: threats are searched deeper, quiet moves
+            // shallower
+            size_t child_depth = depth-1;
+            size_t reduction   = 0;
+            if (selective) {
+                const bool tactical = g.threats(who).test(m) || g.nb_threats_made_by(m, adv) != 0;
+                if (tactical) {
+                    child_depth += extend;
+                } else if (m_selectivity.lmr_moves && depth >= m_selectivity.lmr_depth
+                        && nb_searched >= m_selectivity.lmr_moves) {
+                    reduction = std::min<size_t>(nb_searched >= 2*m_selectivity.lmr_moves ? 2 : 1, child_depth);
+                }
+            }
+            int eval = search_move(g, thread, m, adv, child_depth, ply+1, alpha, beta, first, reduction);
+            if (this->stopped()) {
+                return false; // abort loop
+            }
+            ++nb_searched;
+            if (eval > max) {
+                max = eval;
+                best= m;
+            }
+            if (eval > alpha) {
+                alpha = eval;
+                if (alpha >= beta) {
+                    this->count_cutoff(thread, nb_searched-1);
+                    m_orderings[thread].on_cutoff(m, ply, adv, depth-1);
+                    return false; // abort loop
+                }
+            }
+            return true; // continue
+        };
+        if (depth >= ordering_min_depth) {
+            MoveList moves;
+            m_orderings[thread].generate(g.board(), candidates, ply, adv, hash_move, moves);
+            for (Move m ; moves.next(m) && visit(m) ; ) {
+            }
+        } else {
+            candidates.for_each_bit([&](size_t i) -> bool {
+                    return visit(Move(i));
+                });
+        }
+        if (stopped()) {
+            return 0; // aborted => ignored, and not stored
+        }
+        if (max == std::numeric_limits<int>::min()) { // no child node
+            max = 0;
+        }
+#if DEBUG_AI_LEVEL > 0
+        std::cout << indent << "  "<<g.board().coords(current)<<"-> best move="<<best<<" => "<<max<<"("<<who<< ")\n" ;
+#endif
+        const TT::Bound bound
+            = max <= alpha_orig ? TT::Bound::upper
+            : max >= beta       ? TT::Bound::lower
+            :                     TT::Bound::exact;
+        if (use_tt) {
+            const Move canonical_best = best == no_move ? best
+                : Move(g.symmetries().image(sym, best));
+            m_tt.store(key, depth, bound, TT::score_to_tt(max, depth), canonical_best);
+            if (use_cache && m_cache->writable()) {
+                m_cache->table().store(cache_key, depth, bound, TT::score_to_tt(max, depth), canonical_best);
+            }
+        }
+        return max;
+    }
+
+    /** Minimal depth where the transposition table is used.
+     * Nodes just above the leaves are cheaper to search again than to
+     * fetch from the table.
+     */
+    static const size_t tt_min_depth = 2;
+    /** Minimal depth where the persistent cache is used.
+     * It is slower than the transposition table, and shared by many
+     * searches: only the results worth keeping are written to it.
+     */
+    static const size_t cache_min_depth = 3;
+    /** Minimal depth where the moves are ordered.
+     * Below, the children are leaves: their order hardly matters, and is
+     * not worth sorting them.
+     */
+    static const size_t ordering_min_depth = 2;
+    /** Plies where moves equivalent by symmetry are pruned.
+     * Deeper, positions are seldom symmetric.
+     */
+    static const size_t symmetry_max_ply   = 2;
+    /// Half width of the aspiration windows.
+    static const int    aspiration_delta   = 25;
+
+    const bool                        m_pvs;
+    mutable TranspositionTable        m_tt;
+    std::shared_ptr<PersistentCache>  m_cache;
+    std::shared_ptr<const Tablebase>  m_tablebase;
+    Selectivity                       m_selectivity;
+    /**@name Data of each thread */
+    //@{
+    mutable std::vector<MoveOrdering> m_orderings;
+    mutable std::vector<int>          m_previous_scores;
+    mutable std::vector<size_t>       m_iteration_depths;
+    mutable std::vector<std::uint64_t> m_cache_salts; ///< see \c PersistentCache::salt()
+    //@}
+};
+
+/*===============================[ AIPlayerDC : negascout ]==================*/
+/**@ingroup gPlayerAI
+ * Player decision centre implemented with the negascout algorithm, aka
+ * principal variation search.
+ * This is the negamax with alpha/beta algorithm where:
+ * - the moves after the first one are searched with a null window, and
+ *   searched again only if they appear to be better,
+ * - each iteration starts with an aspiration window centred on the
+ *   score of the previous iteration.
+ * @see http://en.wikipedia.org/wiki/Negascout
+ */
+struct NegaScoutPlayerDC : NegaMaxPlayerAlphaBetaDC
+{
+    /** Init constructor.
+     * @param[in] limits  limits of the search for each move
+     * @param[in] id  player identifier
+     * @param[in] tt_size_in_MB  size of the transposition table
+     * @param[in] nb_threads  number of threads used by the search
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    NegaScoutPlayerDC(SearchLimits const& limits, PlayerId id, size_t tt_size_in_MB = 16, size_t nb_threads = 1)
+        : NegaMaxPlayerAlphaBetaDC(limits, id, tt_size_in_MB, nb_threads, true) {}
+};
+
+/*===============================[ AIPlayerDC : proof-number ]===============*/
+/**@ingroup gPlayerAI
+ * Player decision centre that proves the result of the game with a
+ * depth-first proof-number search (df-pn).
+ *
+ * The proof-number search works on the goal of a player, e.g. winning:
+ * the proof number of a position is the minimal number of positions to
+ * solve in order to prove the goal is reached, and the disproof number
+ * the minimal number to prove it is not. The search always expands the
+ * most promising position, i.e. the one that proves or disproves the
+ * goal with the least effort. Unlike the negamax searches, it is not
+ * bounded by a depth, and its results are exact.
+ *
+ * The depth-first variation keeps the proof numbers in a \c
+ * ProofNumberTable instead of the tree, and searches each position until
+ * its proof numbers exceed thresholds given by its parent. Its memory is
+ * thus bounded by the size of the table.
+ *
+ * Unlike the other searches, all the free squares are searched, since
+ * the neighbourhoods of the tokens cannot be relied upon to prove that a
+ * position is drawn.
+ *
+ * When the result of the position is not proven within half of the
+ * limits of the move, or when it is a loss, the move is chosen by the
+ * negamax with alpha/beta search.
+ * @see https://www.chessprogramming.org/Proof-Number_Search
+ */
+struct ProofNumberPlayerDC : NegaMaxPlayerAlphaBetaDC
+{
+    /// Game-theoretic value of a position, for the player to move.
+    enum class Value { unknown, win, draw, loss };
+    /// Result of \c solve().
+    struct Solution {
+        Value  value;
+        Move   move;  ///< winning, or drawing, move; \c no_move otherwise, or when no move is left
+        size_t nodes; ///< number of positions searched
+    };
+
+    /** Init constructor.
+     * @param[in] limits  limits of the search for each move
+     * @param[in] id  player identifier
+     * @param[in] tt_size_in_MB  size of the transposition table of the
+     * alpha/beta search
+     * @param[in] pn_size_in_MB  size of the table of the proof numbers
+     * @param[in] nb_threads  number of threads used by the alpha/beta
+     * search; the proof-number search is sequential
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    ProofNumberPlayerDC(SearchLimits const& limits, PlayerId id, size_t tt_size_in_MB = 16, size_t pn_size_in_MB = 64, size_t nb_threads = 1)
+        : NegaMaxPlayerAlphaBetaDC(limits, id, tt_size_in_MB, nb_threads)
+        , m_table(pn_size_in_MB)
+        {}
+
+    virtual char const* algorithm() const { return "proof-number"; }
+
+    /** Proves the game-theoretic value of the position, for the player to
+     * move.
+     * The player first tries to prove she wins, and then that she does
+     * not lose.
+     * @param[in,out] g  Game current state; the player to move shall
+     * be the one of this decision centre.
+     * @param[in] max_nodes  maximal number of positions searched, 0 for
+     * no limit
+     * @param[in] max_time  time budget, 0 for no limit
+     * @return the value, \c Value::unknown when the limits are reached;
+     * a position already won is reported without move.
+     * @throw None
+     */
+    Solution solve(GameState & g, size_t max_nodes, std::chrono::milliseconds max_time) const noexcept {
+        m_nodes     = 0;
+        m_max_nodes = max_nodes;
+        m_aborted   = false;
+        m_deadline  = max_time.count()
+            ? std::chrono::steady_clock::now() + max_time
+            : std::chrono::steady_clock::time_point::max();
+        PlayerId adv = m_id; adv ++;
+        Solution res{Value::unknown, no_move, 0};
+        const SquareValue winner = g.winner();
+        if (winner != SquareValue::unoccupied) {
+            res.value = winner == SquareValue(size_t(m_id)) ? Value::win : Value::loss;
+            return res;
+        }
+        Move move = no_move;
+        const Entry win = search(g, m_id, m_id, move);
+        if (win.phi == 0) {
+            res.value = Value::win;
+        } else if (win.delta == 0) {
+            // The adversary tries to win: the player succeeds in the goal
+            // of her adversary's adversary when she draws.
+            const Entry draw = search(g, adv, m_id, move);
+            res.value = draw.phi   == 0 ? Value::draw
+                :       draw.delta == 0 ? Value::loss
+                :                         Value::unknown;
+        }
+        if (res.value == Value::win || res.value == Value::draw) {
+            res.move = move;
+        }
+        res.nodes = m_nodes;
+        return res;
+    }
+
+private:
+    typedef ProofNumberTable::Entry Entry;
+    static const std::uint32_t infinity = ProofNumberTable::infinity;
+
+    /** Proves the result, with half of the limits of the move.
+     * Wins by continuous threats are still looked for first, since they
+     * give the shortest win.
+     */
+    virtual bool prove(GameState & g, Move & best, int & score) const {
+        if (NegaMaxPlayerAlphaBetaDC::prove(g, best, score)) {
+            return true;
+        }
+        const bool limited = limits().nodes || limits().time.count();
+        const Solution s = solve(g,
+                limited ? limits().nodes / 2 : default_max_nodes,
+                limits().time / 2);
+        if ((s.value != Value::win && s.value != Value::draw) || s.move == no_move) {
+            return false;
+        }
+        best  = s.move;
+        score = s.value == Value::win ? proven_win : 0;
+        return true;
+    }
+
+    /// Position searched; only the attacker tries to win.
+    Entry search(GameState & g, PlayerId attacker, PlayerId p, Move & best) const noexcept {
+        return mid(g, attacker, p, infinity, infinity, &best);
+    }
+
+    /** Multiple iterative deepening: searches a position until one of its
+     * proof numbers reaches its threshold.
+     * Proof numbers are expressed from the point of view of the player
+     * to move, in the negamax way: the goal of the attacker is to win,
+     * and the goal of the defender is that the attacker does not win.
+     * @param[in,out] g  Game current state.
+     * @param[in] attacker  player who tries to win
+     * @param[in] p  player to move
+     * @param[in] phi_th  threshold of the proof number
+     * @param[in] delta_th  threshold of the disproof number
+     * @param[out] best  most promising move, searched only at the root,
+     * \c nullptr elsewhere
+     * @return the proof numbers of the position.
+     */
+    Entry mid(GameState & g, PlayerId attacker, PlayerId p, std::uint32_t phi_th, std::uint32_t delta_th, Move * best) const noexcept {
+        const std::uint64_t key = key_of(g, attacker);
+        Entry e;
+        if (terminal(g, attacker, p, e)) {
+            if (best && e.phi == 0 && g.threats(p).any()) {
+                *best = Move(g.threats(p).first());
+            }
+            m_table.store(key, e);
+            return e;
+        }
+        if (exhausted()) {
+            m_aborted = true;
+            return Entry{1, 1, 0};
+        }
+        const size_t nodes_before = m_nodes - 1; // this one included
+
+        // Children are stacked in m_children, from first to last
+        PlayerId adv = p; adv ++;
+        const Mask moves = g.threats(adv).any() ? g.threats(adv) : g.board().empty_squares();
+        const unsigned stabilizer = best ? g.stabilizer() : 0;
+        const bool last_move = g.board().empty_squares().count() == 1;
+        const size_t first = m_children.size();
+        moves.for_each_bit([&](size_t i) -> bool {
+                if (stabilizer && !g.is_canonical_move(i, stabilizer)) {
+                    return true; // continue
+                }
+                const Child child = { salted(g.canonical_hash_after(i, p), attacker), Move(i) };
+                // The moves that may decide the game at once, with a
+                // double threat or by filling the board, are recorded:
+                // they need no search
+                Entry ce;
+                if ((last_move || g.nb_threats_made_by(i, p) >= 2) && !m_table.probe(child.key, ce)) {
+                    g.set(child.move, p);
+                    if (terminal(g, attacker, adv, ce)) {
+                        m_table.store(child.key, ce);
+                    }
+                    g.reset(child.move);
+                }
+                m_children.push_back(child);
+                return true;
+            });
+        const size_t last = m_children.size();
+
+        size_t selected = first;
+        for (;;) {
+            // The player reaches her goal if one of her moves makes her
+            // adversary fail, and fails if all her moves do.
+            std::uint32_t phi_c1   = 0;
+            std::uint32_t delta_c1 = infinity;
+            std::uint32_t delta_c2 = infinity;
+            std::uint64_t sum      = 0;
+            for (size_t c = first; c != last ; ++c) {
+                Entry ce;
+                if (!m_table.probe(m_children[c].key, ce)) {
+                    ce = Entry{1, 1, 0};
+                }
+                sum += ce.phi;
+                if (ce.delta < delta_c1) {
+                    delta_c2 = delta_c1;
+                    delta_c1 = ce.delta;
+                    phi_c1   = ce.phi;
+                    selected = c;
+                } else if (ce.delta < delta_c2) {
+                    delta_c2 = ce.delta;
+                }
+            }
+            e.phi   = delta_c1;
+            e.delta = std::uint32_t(std::min<std::uint64_t>(sum, infinity));
+            if (e.phi >= phi_th || e.delta >= delta_th || m_aborted) {
+                break;
+            }
+            // The most promising child is searched until it is no longer
+            // the most promising, or until the thresholds are reached.
+            const std::uint32_t child_phi_th = std::uint32_t(std::min<std::uint64_t>(
+                        std::uint64_t(delta_th) + phi_c1 - e.delta, infinity));
+            const std::uint32_t child_delta_th = std::uint32_t(std::min<std::uint64_t>(phi_th,
+                        std::uint64_t(delta_c2) + delta_c2 / 4 + 1));
+            const Move where = m_children[selected].move;
+            g.set(where, p);
+            mid(g, attacker, adv, child_phi_th, child_delta_th, nullptr);
+            g.reset(where);
+        }
+        if (best) {
+            *best = m_children[selected].move;
+        }
+        m_children.resize(first);
+        if (!m_aborted) {
+            e.work = std::uint32_t(std::min<size_t>(m_nodes - nodes_before, infinity));
+            m_table.store(key, e);
+        }
+        return e;
+    }
+
+    /** Proof numbers of the positions decided by the threats on the board.
+     * @param[in] attacker  player who tries to win
+     * @param[in] p  player to move
+     * @param[out] e  proof numbers of the position, when decided
+     * @return whether the position is decided.
+     */
+    static bool terminal(GameState const& g, PlayerId attacker, PlayerId p, Entry & e) noexcept {
+        PlayerId adv = p; adv ++;
+        bool reached;
+        if (g.threats(p).any()) {
+            reached = true;  // she wins with her move
+        } else if (g.threats(adv).count() >= 2) {
+            reached = false; // she cannot block all the lines
+        } else if (g.board().empty_squares().none()) {
+            reached = p != attacker; // draw
+        } else {
+            return false;
+        }
+        e = reached ? Entry{0, infinity, 1} : Entry{infinity, 0, 1};
+        return true;
+    }
+
+    /// Key of a position in the table, which depends on the attacker.
+    static std::uint64_t key_of(GameState const& g, PlayerId attacker) noexcept {
+        return salted(g.hash(g.canonical_symmetry()), attacker);
+    }
+    static std::uint64_t salted(std::uint64_t hash, PlayerId attacker) noexcept {
+        return attacker == PlayerId::first ? hash : hash ^ 0x9E3779B97F4A7C15ull;
+    }
+
+    /// Accounts for a new node, and tells whether the limits are reached.
+    bool exhausted() const noexcept {
+        ++m_nodes;
+        return must_stop(0)
+            || (m_max_nodes && m_nodes > m_max_nodes)
+            || (m_nodes % check_period == 0 && std::chrono::steady_clock::now() > m_deadline);
+    }
+
+    /// Move stacked by \c mid(), with the key of the position it leads to.
+    struct Child {
+        std::uint64_t key;
+        Move          move;
+    };
+
+    /// Maximal number of nodes searched by \c prove() without limits.
+    static const size_t default_max_nodes = 1 << 20;
+    /// Number of nodes between two checks of the time.
+    static const size_t check_period = 1024;
+    /** Score of a proven win.
+     * Its length is unknown; it is scored as a known result, a bit
+     * farther than the wins found by the negamax searches.
+     */
+    static const int    proven_win = 951;
+
+    mutable ProofNumberTable                      m_table;
+    mutable std::vector<Child>                    m_children;
+    mutable size_t                                m_nodes;
+    mutable size_t                                m_max_nodes;
+    mutable bool                                  m_aborted;
+    mutable std::chrono::steady_clock::time_point m_deadline;
+};
+
+/*===============================[ AIPlayerDC : MCTS ]=======================*/
+/**@ingroup gPlayerAI
+ * Player decision centre implemented with a Monte-Carlo tree search.
+ * Each playout descends the tree from the current position, choosing
+ * the moves with the UCT formula, which balances the moves that won the
+ * most playouts with the moves seldom tried. Once out of the tree, the
+ * game is played out at random, except that a player completes her
+ * lines and blocks the lines of her adversary. The result of the game is
+ * then accounted in all the nodes visited.
+ *
+ * The tree grows by one level at the nodes visited several times; its
+ * nodes come from an \c Arena, whose size is given in MB: when it is
+ * exhausted, the tree stops growing. The tree may be kept from one move
+ * to the next, in which case the subtree of the new position is searched
+ * further.
+ *
+ * The iterative deepening of \c AIPlayerDC doubles the number of
+ * playouts at each iteration, which makes the search an anytime one:
+ * the maximal depth is the number of doublings, and the nodes counted
+ * are the playouts. The move played is the most visited one.
+ *
+ * With several threads, playouts run in parallel on the same tree.
+ * Visits are accounted as losses as soon as the nodes are descended
+ * (virtual loss), so that the threads spread over different moves.
+ * @see https://en.wikipedia.org/wiki/Monte_Carlo_tree_search
+ */
+struct MCTSPlayerDC : AIPlayerDC
+{
+    /** Init constructor.
+     * @param[in] limits  limits of the search for each move
+     * @param[in] id  player identifier
+     * @param[in] tree_size_in_MB  size of the tree
+     * @param[in] keep_tree  whether the tree is kept from one move to
+     * the next
+     * @param[in] nb_threads  number of threads used by the search
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    MCTSPlayerDC(SearchLimits const& limits, PlayerId id, size_t tree_size_in_MB = 16, bool keep_tree = false, size_t nb_threads = 1)
+        : AIPlayerDC(limits, id, nb_threads)
+        , m_keep_tree(keep_tree)
+        , m_nodes(tree_size_in_MB)
+        , m_root(Arena<Node>::npos)
+        , m_workers(this->nb_threads())
+        {
+            for (size_t t = 0; t != m_workers.size() ; ++t) {
+                m_workers[t].rng.seed(std::mt19937::result_type(t + 1));
+            }
+        }
+
+    virtual char const* algorithm() const { return "mcts"; }
+
+private:
+    /// Node of the tree, reached by a move.
+    struct Node {
+        /// Expansion state.
+        enum State : std::uint8_t { leaf, expanding, expanded };
+        /// (Re)initializes a node allocated.
+        void init(Move move_) {
+            visits.store(0, std::memory_order_relaxed);
+            score .store(0, std::memory_order_relaxed);
+            state .store(leaf, std::memory_order_relaxed);
+            first       = 0;
+            nb_children = 0;
+            move        = move_;
+        }
+        std::atomic<std::uint32_t> visits; ///< playouts through the node, running ones included
+        std::atomic<std::uint32_t> score;  ///< half points of the player who moved, won by the playouts
+        std::atomic<std::uint8_t>  state;
+        std::uint32_t              first;  ///< index of the first child, once expanded
+        std::uint16_t              nb_children;
+        Move                       move;
+    };
+    /// Data of each thread.
+    struct Worker {
+        std::mt19937               rng;
+        std::vector<size_t>        path;   ///< nodes descended
+        std::vector<Move>          free;   ///< free squares of a playout
+        std::vector<Move>          played; ///< moves of a playout
+    };
+
+    virtual int search(GameState & g, size_t depth, Move & best) const {
+        if (depth == 0) { // first iteration
+            new_search(g);
+        }
+        const size_t quota = min_playouts << std::min(depth, max_doublings);
+        std::atomic<size_t> next(0);
+        in_parallel(g, [&](GameState & state, size_t thread) {
+                while (next++ < quota && !this->must_stop(thread, playout_check_period)) {
+                    this->playout(state, thread);
+                }
+            });
+        // The most visited move is the most reliable
+        Node const& root = m_nodes[m_root];
+        if (root.state.load(std::memory_order_acquire) != Node::expanded) {
+            return 0;
+        }
+        std::uint32_t visits = 0;
+        std::uint32_t score  = 0;
+        if (root.nb_children) {
+            best = m_nodes[root.first].move;
+        }
+        for (size_t c = root.first, e = c + root.nb_children; c != e ; ++c) {
+            Node const& child = m_nodes[c];
+            if (child.visits.load(std::memory_order_relaxed) > visits) {
+                visits = child.visits.load(std::memory_order_relaxed);
+                score  = child.score.load(std::memory_order_relaxed);
+                best   = child.move;
+            }
+        }
+        const double mean = visits ? score / (2. * visits) : .5;
+        return int((2 * mean - 1) * GameState::max_evaluation);
+    }
+
+    /** Sets the root of the tree on the current position.
+     * When the tree is kept, the node of the position after the last
+     * move chosen and the reply of the adversary becomes the root,
+     * unless the tree is half full. Otherwise, the tree starts afresh.
+     */
+    void new_search(GameState const& g) const {
+        const std::array<Mask, 2> stones = {{
+            g.board().stones(SquareValue::first),
+                g.board().stones(SquareValue::second)
+        }};
+        size_t root = Arena<Node>::npos;
+        if (m_keep_tree && m_root != Arena<Node>::npos && m_nodes.size() <= m_nodes.capacity() / 2) {
+            PlayerId adv = m_id; adv ++;
+            const Mask mine   = stones[size_t(m_id)-1] ^ m_root_stones[size_t(m_id)-1];
+            const Mask theirs = stones[size_t(adv) -1] ^ m_root_stones[size_t(adv) -1];
+            if (mine.count() == 1 && theirs.count() == 1
+                    && (mine   & m_root_stones[size_t(m_id)-1]).none()
+                    && (theirs & m_root_stones[size_t(adv) -1]).none()) {
+                root = child(child(m_root, mine.first()), theirs.first());
+            }
+        }
+        if (root == Arena<Node>::npos) {
+            m_nodes.clear();
+            root = m_nodes.allocate(1);
+            m_nodes[root].init(0);
+        }
+        m_root        = root;
+        m_root_stones = stones;
+        // The root always has children to choose from, even when the
+        // playouts stop there since the game is decided
+        Node & node = m_nodes[m_root];
+        if (node.state.load(std::memory_order_relaxed) != Node::expanded && expand(g, m_root, m_id)) {
+            node.state.store(Node::expanded, std::memory_order_release);
+        }
+    }
+    /// Child of an expanded node reached by a move, \c npos if none.
+    size_t child(size_t parent, size_t move) const {
+        if (parent == Arena<Node>::npos) {
+            return Arena<Node>::npos;
+        }
+        Node const& node = m_nodes[parent];
+        if (node.state.load(std::memory_order_acquire) == Node::expanded) {
+            for (size_t c = node.first, e = c + node.nb_children; c != e ; ++c) {
+                if (m_nodes[c].move == move) {
+                    return c;
+                }
+            }
+        }
+        return Arena<Node>::npos;
+    }
+
+    /** Runs a playout from the root.
+     * @param[in,out] g  Game state of the root; it is restored.
+     * @param[in] thread  thread running the playout
+     */
+    void playout(GameState & g, size_t thread) const noexcept {
+        Worker & w = m_workers[thread];
+        w.path.clear();
+        size_t   n = m_root;
+        PlayerId p = m_id;
+        SquareValue winner = SquareValue::unoccupied;
+        bool decided = false;
+        m_nodes[n].visits.fetch_add(1, std::memory_order_relaxed);
+        // Descent in the tree
+        for (;;) {
+            if ((decided = decided_by_threats(g, p, winner))) {
+                break;
+            }
+            Node & node = m_nodes[n];
+            std::uint8_t state = node.state.load(std::memory_order_acquire);
+            if (state == Node::leaf && node.visits.load(std::memory_order_relaxed) >= expand_visits
+                    && node.state.compare_exchange_strong(state, Node::expanding, std::memory_order_acquire)) {
+                state = expand(g, n, p) ? Node::expanded : Node::leaf;
+                node.state.store(state, std::memory_order_release);
+            }
+            if (state != Node::expanded || node.nb_children == 0) {
+                break;
+            }
+            n = select(node);
+            m_nodes[n].visits.fetch_add(1, std::memory_order_relaxed); // virtual loss
+            g.set(m_nodes[n].move, p);
+            w.path.push_back(n);
+            p ++;
+        }
+        if (!decided) {
+            winner = play_out(g, p, w);
+        }
+        for (size_t i = w.path.size(); i-- ; ) {
+            g.reset(m_nodes[w.path[i]].move);
+        }
+        // Backpropagation: the visits are already accounted
+        PlayerId mover = m_id;
+        for (size_t c : w.path) {
+            const std::uint32_t points
+                = winner == SquareValue(size_t(mover)) ? 2
+                : winner == SquareValue::unoccupied    ? 1
+                :                                        0;
+            m_nodes[c].score.fetch_add(points, std::memory_order_relaxed);
+            mover ++;
+        }
+    }
+
+    /** Tells whether the threats on the board decide the game.
+     * @param[in] p  player to move
+     * @param[out] winner  winner, if decided
+     */
+    static bool decided_by_threats(GameState const& g, PlayerId p, SquareValue & winner) noexcept {
+        PlayerId adv = p; adv ++;
+        if (g.threats(p).any()) {
+            winner = SquareValue(size_t(p));
+            return true;
+        } else if (g.threats(adv).count() >= 2) {
+            winner = SquareValue(size_t(adv));
+            return true;
+        } else if (g.board().empty_squares().none()) {
+            winner = SquareValue::unoccupied;
+            return true;
+        }
+        return false;
+    }
+
+    /** Adds the children of a node to the tree.
+     * Moves equivalent by symmetry are only added at the root.
+     * @return whether there was enough room in the tree.
+     */
+    bool expand(GameState const& g, size_t n, PlayerId p) const noexcept {
+        int unused;
+        Mask moves;
+        forced_moves(g, p, 0, unused, moves);
+        const unsigned stabilizer = n == m_root ? g.stabilizer() : 0;
+        if (stabilizer) {
+            moves.for_each_bit([&](size_t i) -> bool {
+                    if (!g.is_canonical_move(i, stabilizer)) moves.reset(i);
+                    return true;
+                });
+        }
+        const size_t first = m_nodes.allocate(moves.count());
+        if (first == Arena<Node>::npos) {
+            return false;
+        }
+        size_t c = first;
+        moves.for_each_bit([&](size_t i) -> bool {
+                m_nodes[c++].init(Move(i));
+                return true;
+            });
+        Node & node = m_nodes[n];
+        node.first       = std::uint32_t(first);
+        node.nb_children = std::uint16_t(c - first);
+        return true;
+    }
+
+    /// Child to descend, with the UCT formula.
+    size_t select(Node const& node) const noexcept {
+        const double log_visits = std::log(double(std::max<std::uint32_t>(node.visits.load(std::memory_order_relaxed), 1)));
+        size_t best  = node.first;
+        double value = -1;
+        for (size_t c = node.first, e = c + node.nb_children; c != e ; ++c) {
+            Node const& child = m_nodes[c];
+            const std::uint32_t visits = child.visits.load(std::memory_order_relaxed);
+            if (visits == 0) {
+                return c; // each move is tried once first
+            }
+            const double v = child.score.load(std::memory_order_relaxed) / (2. * visits)
+                + exploration * std::sqrt(log_visits / visits);
+            if (v > value) {
+                value = v;
+                best  = c;
+            }
+        }
+        return best;
+    }
+
+    /** Plays the game out, from a position out of the tree.
+     * Players complete their lines, block the lines of their adversary,
+     * and otherwise play at random.
+     * @param[in,out] g  game state; it is restored.
+     * @param[in] p  player to move
+     * @param[in,out] w  data of the thread
+     * @return the winner, \c SquareValue::unoccupied for a draw.
+     */
+    static SquareValue play_out(GameState & g, PlayerId p, Worker & w) noexcept {
+        w.free.clear();
+        w.played.clear();
+        g.board().empty_squares().for_each_bit([&](size_t i) -> bool {
+                w.free.push_back(Move(i));
+                return true;
+            });
+        SquareValue winner;
+        while (!decided_by_threats(g, p, winner)) {
+            PlayerId adv = p; adv ++;
+            size_t k;
+            if (g.threats(adv).any()) {
+                const Move block = Move(g.threats(adv).first());
+                k = size_t(std::find(w.free.begin(), w.free.end(), block) - w.free.begin());
+            } else {
+                k = w.rng() % w.free.size();
+            }
+            const Move move = w.free[k];
+            w.free[k] = w.free.back();
+            w.free.pop_back();
+            g.set(move, p);
+            w.played.push_back(move);
+            p = adv;
+        }
+        for (size_t i = w.played.size(); i-- ; ) {
+            g.reset(w.played[i]);
+        }
+        return winner;
+    }
+
+    /// Number of playouts of the first iteration.
+    static const size_t min_playouts  = 128;
+    /// Maximal number of times the number of playouts is doubled.
+    static const size_t max_doublings = 24;
+    /// Number of playouts between two checks of the limits: a playout
+    /// costs a whole game, so the clock is read more often than by
+    /// the tree searches.
+    static const size_t playout_check_period = 32;
+    /// Number of visits of a leaf before its children are added.
+    static const std::uint32_t expand_visits = 2;
+    /// Weight of the exploration in the UCT formula.
+    static constexpr double exploration = 0.7;
+
+    const bool                          m_keep_tree;
+    mutable Arena<Node>                 m_nodes;
+    mutable size_t                      m_root;
+    mutable std::array<Mask, 2>         m_root_stones;
+    mutable std::vector<Worker>         m_workers;
+};
+
+
+/*===========================================================================*/
+/*============================[ Batch self-play ]============================*/
+/*===========================================================================*/
+/**@defgroup gBatch Batch self-play
+ * Plays many silent games between two AI players, over a pool of
+ * threads, in order to compare them.
+ * @{
+ */
+/// Builds the decision centre of a player, for the given player id.
+typedef std::function<std::unique_ptr<PlayerDC> (PlayerId)> PlayerFactory;
+
+/** Sequential probability ratio test of a batch of games.
+ * It tells, as soon as the games played are enough, whether the Elo
+ * difference between the two players is rather \c elo0 (hypothesis H0)
+ * or \c elo1 (hypothesis H1), with error rates \c alpha and \c beta.
+ *
+ * The log-likelihood ratio of the results is approximated as a
+ * generalised SPRT does, from the mean and the variance of the score of
+ * a game: 1 for a win, 1/2 for a draw, 0 for a loss. H1 is accepted
+ * when it reaches <tt>log((1-beta)/alpha)</tt>, and H0 when it falls to
+ * <tt>log(beta/(1-alpha))</tt>.
+ */
+struct Sprt
+{
+    /// Result of the test.
+    enum class Verdict { undecided, h0, h1 };
+
+    /// Init constructor: disabled test.
+    Sprt() : enabled(false), elo0(0), elo1(5), alpha(0.05), beta(0.05) {}
+
+    /** Log-likelihood ratio of H1 against H0, given the results of the
+     * first player.
+     * @throw None
+     */
+    double llr(size_t wins, size_t draws, size_t losses) const noexcept {
+        const double n = double(wins + draws + losses);
+        if (n == 0) {
+            return 0;
+        }
+        const double w = wins / n, d = draws / n, l = losses / n;
+        const double mean = w + d / 2;
+        const double variance = w * (1-mean) * (1-mean) + d * (.5-mean) * (.5-mean) + l * mean * mean;
+        if (variance <= 0) {
+            return 0; // all the games have the same result: nothing to tell
+        }
+        const double s0 = score_of(elo0);
+        const double s1 = score_of(elo1);
+        return n * (s1 - s0) * (2*mean - s0 - s1) / (2 * variance);
+    }
+    /// Bound of the log-likelihood ratio that accepts H0.
+    double lower_bound() const { return std::log(beta / (1-alpha)); }
+    /// Bound of the log-likelihood ratio that accepts H1.
+    double upper_bound() const { return std::log((1-beta) / alpha); }
+    /// Verdict given by a log-likelihood ratio.
+    Verdict verdict(double llr) const {
+        return !enabled             ? Verdict::undecided
+            :  llr >= upper_bound() ? Verdict::h1
+            :  llr <= lower_bound() ? Verdict::h0
+            :                         Verdict::undecided;
+    }
+
+    /// Expected score of a player with an Elo advantage.
+    static double score_of(double elo) { return 1 / (1 + std::pow(10., -elo / 400)); }
+    /** Elo advantage of a player with an expected score.
+     * @pre <tt>0 < score < 1</tt>
+     */
+    static double elo_of(double score) { return -400 * std::log10(1 / score - 1); }
+
+    bool   enabled;
+    double elo0;  ///< Elo difference of H0
+    double elo1;  ///< Elo difference of H1
+    double alpha; ///< probability to accept H1 when H0 holds
+    double beta;  ///< probability to accept H0 when H1 holds
+};
+
+/// Options of a batch of games.
+struct BatchOptions
+{
+    BatchOptions() : nb_games(0), nb_jobs(1), nb_random_moves(2), seed(0) {}
+
+    size_t                           nb_games;        ///< maximal number of games, when the SPRT is enabled
+    size_t                           nb_jobs;         ///< number of games played at once
+    size_t                           nb_random_moves; ///< length of random openings
+    std::uint64_t                    seed;            ///< seed of random openings
+    std::vector<std::vector<Coords>> book;            ///< openings used instead of random ones
+    Sprt                             sprt;            ///< stops the batch early
+};
+
+/** Reads a book of openings.
+ * Each line lists the moves of an opening, as \c "l c" pairs. Empty
+ * lines, and lines starting with \c '#' are ignored.
+ * @throw std::runtime_error if a line cannot be decoded.
+ */
+std::vector<std::vector<Coords>> read_book(std::istream & is)
+{
+    std::vector<std::vector<Coords>> book;
+    std::string line;
+    while (std::getline(is, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream iss(line);
+        std::vector<Coords> opening;
+        size_t l, c;
+        while (iss >> l >> c) {
+            opening.push_back(Coords{l, c});
+        }
+        if (!iss.eof()) {
+            throw std::runtime_error("Invalid opening: " + line);
+        }
+        book.push_back(std::move(opening));
+    }
+    return book;
+}
+
+/** Batch of games between two AI players.
+ * Games are played by pairs that share the same opening, with the
+ * players swapping sides. Each game runs on a single job, and jobs
+ * share nothing but the index of the next game to play, and the
+ * results.
+ *
+ * When the \c Sprt of the options is enabled, no game is started once
+ * it has reached its verdict; the games in progress are still
+ * accounted.
+ */
+struct Batch
+{
+    /** Init constructor.
+     * @param[in] start  state from which games start, before openings
+     * @param[in] factories  builders of the two players
+     * @param[in] names  names of the two players
+     * @param[in] options  options of the batch
+     */
+    Batch(GameState const& start, std::array<PlayerFactory, 2> factories,
+            std::array<std::string, 2> names, BatchOptions options)
+        : m_start(start)
+        , m_factories(std::move(factories))
+        , m_names(std::move(names))
+        , m_options(std::move(options))
+        , m_llr(0)
+        , m_verdict(Sprt::Verdict::undecided)
+        {}
+
+    /// Results of games, from the point of view of the first player.
+    struct Results {
+        Results() : wins(0), draws(0), losses(0) {}
+        size_t                         wins;
+        size_t                         draws;
+        size_t                         losses;
+        std::array<AIPlayerDC::Stats, 2> stats;
+
+        /// Number of games.
+        size_t games() const { return wins + draws + losses; }
+        /// Points of the first player: 1 per win, 1/2 per draw.
+        double points() const { return wins + draws / 2.; }
+
+        Results & operator+=(Results const& r) {
+            wins += r.wins; draws += r.draws; losses += r.losses;
+            for (size_t e = 0; e != 2 ; ++e) {
+                stats[e].moves += r.stats[e].moves;
+                stats[e].nodes += r.stats[e].nodes;
+                stats[e].time  += r.stats[e].time;
+            }
+            return *this;
+        }
+    };
+    /// Results of the games played by \c run().
+    Results const& results() const { return m_results; }
+
+    /** Plays all the games, and prints a summary.
+     * @throw std::runtime_error if a player is not an AI, or if an
+     * opening cannot be played.
+     * @throw std::system_error if threads cannot be started.
+     */
+    void run(std::ostream & os) {
+        typedef std::chrono::steady_clock clock;
+        const clock::time_point start = clock::now();
+        m_next_game.store(0);
+        const size_t nb_jobs = std::max<size_t>(1, std::min(m_options.nb_jobs, m_options.nb_games));
+        std::vector<std::thread> jobs;
+        try {
+            for (size_t j = 1; j < nb_jobs ; ++j) {
+                jobs.emplace_back([this](){ this->job(); });
+            }
+        } catch (...) {
+            m_next_game.store(m_options.nb_games);
+            for (auto & t : jobs) t.join();
+            throw;
+        }
+        job();
+        for (auto & t : jobs) t.join();
+        if (m_error) {
+            std::rethrow_exception(m_error);
+        }
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start);
+
+        os << m_results.games() << " games, " << nb_jobs << " jobs, " << elapsed.count() << "ms\n"
+            << m_names[0] << " vs " << m_names[1] << ": "
+            << "+" << m_results.wins << " =" << m_results.draws << " -" << m_results.losses
+            << elo(m_results) << "\n";
+        if (m_options.sprt.enabled) {
+            Sprt const& t = m_options.sprt;
+            char line[128];
+            std::snprintf(line, sizeof(line), "SPRT elo0 %g elo1 %g: LLR %.2f [%.2f, %.2f], ",
+                    t.elo0, t.elo1, m_llr, t.lower_bound(), t.upper_bound());
+            os << line
+                << (m_verdict == Sprt::Verdict::h1 ? "H1 accepted"
+                :   m_verdict == Sprt::Verdict::h0 ? "H0 accepted"
+                :                                    "inconclusive") << "\n";
+        }
+        for (size_t e = 0; e != 2 ; ++e) {
+            AIPlayerDC::Stats const& st = m_results.stats[e];
+            const double moves = std::max<double>(st.moves, 1);
+            os << m_names[e] << ": " << st.moves << " moves"
+                << ", " << double(st.time.count()) / 1000 / moves << " ms/move"
+                << ", " << size_t(double(st.nodes) / moves) << " nodes/move\n";
+        }
+    }
+
+    /** Estimated Elo difference of the first player, with its 95%
+     * confidence interval, as printed after the results.
+     * The interval is omitted when too few games were played, or when
+     * they all ended the same way, since it would be meaningless.
+     * @return an empty string when it cannot be estimated.
+     */
+    static std::string elo(Results const& r) {
+        const double n = double(r.games());
+        const double mean = r.points() / std::max(n, 1.);
+        if (mean <= 0 || mean >= 1) {
+            return std::string();
+        }
+        const double variance
+            = (r.wins * (1-mean) * (1-mean) + r.draws * (.5-mean) * (.5-mean) + r.losses * mean * mean) / n;
+        const double margin = 1.96 * std::sqrt(variance / n);
+        const double value  = std::round(Sprt::elo_of(mean)) + 0.; // no "-0"
+        char line[64];
+        if (n >= min_games_for_interval && variance > 0
+                && mean - margin > 0 && mean + margin < 1) {
+            std::snprintf(line, sizeof(line), ", elo %+.0f +/- %.0f", value,
+                    (Sprt::elo_of(mean + margin) - Sprt::elo_of(mean - margin)) / 2);
+        } else {
+            std::snprintf(line, sizeof(line), ", elo %+.0f", value);
+        }
+        return line;
+    }
+
+private:
+    /** Plays games till there is none left.
+     * The results are accounted after each game, so that the SPRT can
+     * stop the batch as soon as possible.
+     */
+    void job() {
+        try {
+            for (size_t n ; (n = m_next_game.fetch_add(1)) < m_options.nb_games ; ) {
+                Results results;
+                play(n, results);
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_results += results;
+                if (m_options.sprt.enabled && m_verdict == Sprt::Verdict::undecided) {
+                    m_llr     = m_options.sprt.llr(m_results.wins, m_results.draws, m_results.losses);
+                    m_verdict = m_options.sprt.verdict(m_llr);
+                    if (m_verdict != Sprt::Verdict::undecided) {
+                        m_next_game.store(m_options.nb_games); // stop the other jobs
+                    }
+                }
+            }
+        } catch (...) {
+            m_next_game.store(m_options.nb_games); // stop the other jobs
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_error) m_error = std::current_exception();
+        }
+    }
+
+    /// Plays the n-th game.
+    void play(size_t n, Results & results) const {
+        // Games 2k and 2k+1 share the same opening, with swapped sides
+        const size_t swapped = n % 2;
+        Game g(m_start);
+        g.log_to(nullptr);
+        open(n / 2, g);
+
+        std::array<AIPlayerDC const*, 2> ai;
+        for (size_t side = 0; side != 2 ; ++side) {
+            const size_t e = side ^ swapped;
+            std::unique_ptr<PlayerDC> dc = m_factories[e](PlayerId(side+1));
+            ai[e] = dynamic_cast<AIPlayerDC const*>(dc.get());
+            if (!ai[e]) {
+                throw std::runtime_error("Only AI players can play batches of games");
+            }
+            g.push(std::move(dc), std::string(m_names[e]));
+        }
+        const size_t winner = g.run();
+        if (winner == 0)                        results.draws ++;
+        else if (((winner-1) ^ swapped) == 0)   results.wins ++;
+        else                                    results.losses ++;
+        for (size_t e = 0; e != 2 ; ++e) {
+            results.stats[e].moves += ai[e]->stats().moves;
+            results.stats[e].nodes += ai[e]->stats().nodes;
+            results.stats[e].time  += ai[e]->stats().time;
+        }
+    }
+
+    /** Plays the k-th opening.
+     * Random openings never contain winning moves.
+     * @throw std::runtime_error if a move from the book cannot be played.
+     */
+    void open(size_t k, Game & g) const {
+        if (!m_options.book.empty()) {
+            for (Coords const& c : m_options.book[k % m_options.book.size()]) {
+                if (std::get<0>(c) >= g.L() || std::get<1>(c) >= g.C()
+                        || g.is_a_winning_move_for(Move(g.board().index(c)), g.next_player())
+                        || !g.play(Move(g.board().index(c)))) {
+                    std::ostringstream oss;
+                    oss << "Cannot play " << c << " in opening #" << k % m_options.book.size();
+                    throw std::runtime_error(oss.str());
+                }
+            }
+            return;
+        }
+        std::seed_seq seed{std::uint64_t(m_options.seed), std::uint64_t(k)};
+        std::mt19937_64 rng(seed);
+        for (size_t m = 0; m != m_options.nb_random_moves ; ++m) {
+            std::vector<Move> moves;
+            const PlayerId who = g.next_player();
+            g.for_each_possible_move([&](Move move) -> bool {
+                    if (!g.is_a_winning_move_for(move, who)) moves.push_back(move);
+                    return true;
+                });
+            if (moves.empty()) return;
+            g.play(moves[std::uniform_int_distribution<size_t>(0, moves.size()-1)(rng)]);
+        }
+    }
+
+    /// Number of games below which no confidence interval is printed.
+    static const size_t min_games_for_interval = 10;
+
+    const GameState                   m_start;
+    const std::array<PlayerFactory, 2> m_factories;
+    const std::array<std::string, 2>  m_names;
+    const BatchOptions                m_options;
+    std::atomic<size_t>               m_next_game;
+    std::mutex                        m_mutex;
+    Results                           m_results;
+    double                            m_llr;     ///< when the SPRT has decided, or after the last game
+    Sprt::Verdict                     m_verdict;
+    std::exception_ptr                m_error;
+};
+
+/** Tournament between several AI players.
+ * Each pairing plays a \c Batch, with the same options, hence the same
+ * openings: a round-robin pairs all the players, and a gauntlet pairs
+ * the first player with each of the others. The pairings are played one
+ * after the other, each one over all the jobs; with the SPRT enabled,
+ * each one stops as soon as its result is significant.
+ *
+ * The standings rank the players by their share of the points of their
+ * games.
+ */
+struct Tournament
+{
+    /// Pairings of the players.
+    enum class Format { round_robin, gauntlet };
+
+    /** Init constructor.
+     * @param[in] start  state from which games start, before openings
+     * @param[in] factories  builders of the players
+     * @param[in] names  names of the players
+     * @param[in] format  pairings of the players
+     * @param[in] options  options of the batch of each pairing
+     * @pre <tt>factories.size() == names.size()</tt>, checked with an
+     * assertion
+     * @throw std::runtime_error if there are less than two players.
+     */
+    Tournament(GameState const& start, std::vector<PlayerFactory> factories,
+            std::vector<std::string> names, Format format, BatchOptions options)
+        : m_start(start)
+        , m_factories(std::move(factories))
+        , m_names(std::move(names))
+        , m_format(format)
+        , m_options(std::move(options))
+        {
+            assert(m_factories.size() == m_names.size());
+            if (m_factories.size() < 2) {
+                throw std::runtime_error("A tournament expects at least two players");
+            }
+        }
+
+    /** Plays all the pairings, and prints their summaries and the
+     * standings.
+     * @throw std::runtime_error if a player is not an AI, or if an
+     * opening cannot be played.
+     * @throw std::system_error if threads cannot be started.
+     */
+    void run(std::ostream & os) {
+        const size_t N = m_factories.size();
+        std::vector<Standing> standings(N);
+        for (size_t p = 0; p != N ; ++p) {
+            standings[p].player = p;
+        }
+        for (size_t i = 0; i != N ; ++i) {
+            for (size_t j = i+1; j != N ; ++j) {
+                if (m_format == Format::gauntlet && i != 0) {
+                    continue;
+                }
+                os << "\n";
+                Batch b(m_start, {{m_factories[i], m_factories[j]}}, {{m_names[i], m_names[j]}}, m_options);
+                b.run(os);
+                Batch::Results const& r = b.results();
+                standings[i].points += r.points();
+                standings[i].games  += r.games();
+                standings[j].points += r.games() - r.points();
+                standings[j].games  += r.games();
+            }
+        }
+
+        std::stable_sort(standings.begin(), standings.end(), [](Standing const& a, Standing const& b) {
+                return a.share() > b.share();
+                });
+        os << "\nStandings:\n";
+        for (size_t k = 0; k != N ; ++k) {
+            Standing const& st = standings[k];
+            char line[64];
+            std::snprintf(line, sizeof(line), "%3zu. %6.1f/%-6zu %5.1f%%  ",
+                    k+1, st.points, st.games, 100 * st.share());
+            os << line << m_names[st.player] << "\n";
+        }
+    }
+
+private:
+    /// Points of a player over all her pairings.
+    struct Standing {
+        Standing() : player(0), points(0), games(0) {}
+        /// Share of the points of the games played.
+        double share() const { return games ? points / games : 0; }
+        size_t player;
+        double points;
+        size_t games;
+    };
+
+    const GameState                  m_start;
+    const std::vector<PlayerFactory> m_factories;
+    const std::vector<std::string>   m_names;
+    const Format                     m_format;
+    const BatchOptions               m_options;
+};
+//@}
+
+/*===========================================================================*/
+/*=============================[ Batch analysis ]============================*/
+/*===========================================================================*/
+/**@defgroup gAnalysis Batch analysis
+ * Searches many positions with an AI player, over a pool of threads,
+ * and prints the result of each one.
+ * @{
+ */
+/** Analysis of a stream of positions.
+ * Positions are read in the format of \c operator>>(), separated by
+ * \c "<<EOF" lines, and searched by the player to move. One line is
+ * written per position, in the order of the input:
+ * <tt>index: {l,c} score S depth D nodes N</tt>, where the index starts
+ * at 0, and the move is \c - when there is no move left. Positions where
+ * the game is over are not searched: their line is
+ * <tt>index: terminal: win X</tt> (or \c O), or
+ * <tt>index: terminal: draw</tt>.
+ *
+ * Positions are read as the jobs search them: only a few of them are
+ * kept in memory at once, so that the input may be of any length, or
+ * be fed live by another program. Each job reuses its players from one
+ * position to the next, unless the size of the board changes.
+ */
+struct Analysis
+{
+    /** Init constructor.
+     * @param[in] start  state whose settings (number of tokens to
+     * align, radius) apply to the positions read
+     * @param[in] factory  builder of the player
+     * @param[in] nb_jobs  number of positions searched at once
+     */
+    Analysis(GameState const& start, PlayerFactory factory, size_t nb_jobs)
+        : m_start(start)
+        , m_factory(std::move(factory))
+        , m_nb_jobs(std::max<size_t>(nb_jobs, 1))
+        {}
+
+    /** Analyses all the positions of a stream.
+     * @throw std::runtime_error if a position cannot be decoded, or if
+     * the player is not an AI.
+     * @throw std::system_error if threads cannot be started.
+     */
+    void run(std::istream & is, std::ostream & os) {
+        m_os       = &os;
+        m_first    = 0;
+        m_next     = 0;
+        m_finished = false;
+        m_error    = nullptr;
+        std::vector<std::thread> jobs;
+        try {
+            for (size_t j = 0; j != m_nb_jobs ; ++j) {
+                jobs.emplace_back([this](){ this->job(); });
+            }
+            read(is);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_error) m_error = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_finished = true;
+        }
+        m_ready.notify_all();
+        for (auto & t : jobs) t.join();
+        os.flush();
+        if (m_error) {
+            std::rethrow_exception(m_error);
+        }
+    }
+
+private:
+    /// Position read, and its result once searched.
+    struct Task {
+        std::string board;
+        std::string result;
+        bool        done;
+    };
+
+    /// Reads the positions, and queues them for the jobs.
+    void read(std::istream & is) {
+        std::string board, line;
+        size_t width = 0;
+        size_t index = 0;
+        for (bool more = true; more ; ) {
+            more = bool(std::getline(is, line));
+            if (more && !line.empty() && line[0] == '|') {
+                if (!board.empty() && line.size() != width) {
+                    throw std::runtime_error("Invalid board #" + std::to_string(index)
+                            + ": rows of different sizes");
+                }
+                width = line.size();
+                board += line;
+                board += '\n';
+            } else if ((!more || line == "<<EOF") && !board.empty()) {
+                push(std::move(board));
+                board.clear();
+                ++index;
+            }
+        }
+    }
+
+    /// Queues a position, once there is room for it.
+    void push(std::string && board) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_room.wait(lock, [this]{ return m_tasks.size() < max_pending * m_nb_jobs || m_error; });
+        if (m_error) {
+            throw std::runtime_error("Analysis aborted");
+        }
+        m_tasks.push_back(Task{std::move(board), std::string(), false});
+        lock.unlock();
+        m_ready.notify_one();
+    }
+
+    /// Searches positions till there is none left.
+    void job() {
+        std::array<std::unique_ptr<PlayerDC>, 2> players;
+        Coords size;
+        try {
+            for (;;) {
+                size_t      index;
+                std::string board;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_ready.wait(lock, [this]{
+                            return m_next < m_first + m_tasks.size() || m_finished || m_error;
+                            });
+                    if (m_error || m_next == m_first + m_tasks.size()) {
+                        return;
+                    }
+                    index = m_next++;
+                    board = m_tasks[index - m_first].board;
+                }
+                const std::string result = analyse(board, players, size);
+                std::lock_guard<std::mutex> lock(m_mutex);
+                Task & t = m_tasks[index - m_first];
+                t.result = std::to_string(index) + ": " + result;
+                t.done   = true;
+                write();
+            }
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_error) m_error = std::current_exception();
+            }
+            m_ready.notify_all();
+            m_room.notify_all();
+        }
+    }
+
+    /** Searches a position.
+     * @param[in] board  position, in the format of \c operator>>()
+     * @param[in,out] players  players of the job, by player to move
+     * @param[in,out] size  size of the board they have searched
+     * @return the result line, without its index.
+     */
+    std::string analyse(std::string const& board, std::array<std::unique_ptr<PlayerDC>, 2> & players, Coords & size) const {
+        GameState state(m_start);
+        std::istringstream iss(board);
+        iss >> state;
+        Game g(state);
+        g.log_to(nullptr);
+        const SquareValue winner = g.winner();
+        if (winner != SquareValue::unoccupied) {
+            return std::string("terminal: win ") + Square(winner).as_char();
+        } else if (g.board().empty_squares().none()) {
+            return "terminal: draw";
+        }
+        if (g.M() != size) {
+            size = g.M();
+            for (auto & p : players) p.reset();
+        }
+        const PlayerId id = g.next_player();
+        std::unique_ptr<PlayerDC> & dc = players[size_t(id)-1];
+        if (!dc) {
+            dc = m_factory(id);
+        }
+        AIPlayerDC const* ai = dynamic_cast<AIPlayerDC const*>(dc.get());
+        if (!ai) {
+            throw std::runtime_error("Only AI players can analyse positions");
+        }
+        ai->choose(g);
+        AIPlayerDC::Choice const& c = ai->last_choice();
+        std::ostringstream os;
+        if (c.move == no_move) {
+            os << "-";
+        } else {
+            os << g.board().coords(c.move);
+        }
+        os << " score " << c.score << " depth " << c.depth << " nodes " << c.nodes;
+        return os.str();
+    }
+
+    /// Writes the results available in the order of the input; locked.
+    void write() {
+        bool written = false;
+        while (!m_tasks.empty() && m_tasks.front().done) {
+            *m_os << m_tasks.front().result << '\n';
+            m_tasks.pop_front();
+            ++m_first;
+            written = true;
+        }
+        if (written) {
+            m_os->flush();
+            m_room.notify_one();
+        }
+    }
+
+    /// Number of positions kept in memory per job.
+    static const size_t max_pending = 4;
+
+    const GameState          m_start;
+    const PlayerFactory      m_factory;
+    const size_t             m_nb_jobs;
+    std::ostream *           m_os;
+    /**@name Shared by the reader and the jobs, guarded by \c m_mutex */
+    //@{
+    std::mutex               m_mutex;
+    std::condition_variable  m_ready; ///< a position is queued, or the input is over
+    std::condition_variable  m_room;  ///< there is room for a position
+    std::deque<Task>         m_tasks; ///< from the first result not written yet
+    size_t                   m_first; ///< index of the first task
+    size_t                   m_next;  ///< index of the next task to search
+    bool                     m_finished;
+    std::exception_ptr       m_error;
+    //@}
+};
+//@}
+
+/*===========================================================================*/
+/*================================[ Census ]=================================*/
+/*===========================================================================*/
+/**@defgroup gCensus Census of the positions
+ * Counts the positions reachable from a position, ply by ply.
+ * @{
+ */
+/** Set of 64-bit keys shared by threads, without locks.
+ * Fixed-size open addressing hash table; a key is inserted by a single
+ * compare-and-swap on a free slot.
+ */
+struct ConcurrentHashSet
+{
+    /** Init constructor.
+     * @param[in] size_in_MB  memory allocated to the set
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    explicit ConcurrentHashSet(size_t size_in_MB) : m_size(1), m_count(0), m_has_zero(false) {
+        const size_t nb = std::max<size_t>((size_in_MB << 20) / sizeof(Slot), 2);
+        while (m_size*2 <= nb) m_size *= 2;
+        m_slots.reset(new Slot[m_size]);
+        for (size_t i=0; i!=m_size ; ++i) m_slots[i].store(0, std::memory_order_relaxed);
+    }
+    /** Inserts a key.
+     * @return whether the key was not in the set yet.
+     * @throw std::runtime_error if the set is full.
+     */
+    bool insert(std::uint64_t key) {
+        if (key == 0) { // 0 marks the free slots
+            return !m_has_zero.exchange(true, std::memory_order_relaxed);
+        }
+        // Keys are Zobrist hashes: their low bits are already mixed
+        for (size_t i = key & (m_size-1), n = 0; n != m_size ; i = (i+1) & (m_size-1), ++n) {
+            std::uint64_t k = m_slots[i].load(std::memory_order_relaxed);
+            if (k == 0 && m_slots[i].compare_exchange_strong(k, key, std::memory_order_relaxed)) {
+                m_count.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            if (k == key) {
+                return false;
+            }
+        }
+        throw std::runtime_error("The set of positions is full");
+    }
+    /// Number of keys.
+    size_t size() const { return m_count.load(std::memory_order_relaxed) + m_has_zero.load(std::memory_order_relaxed); }
+    /// Number of slots.
+    size_t capacity() const { return m_size; }
+    /// Memory used, in bytes.
+    size_t bytes() const { return m_size * sizeof(Slot); }
+private:
+    typedef std::atomic<std::uint64_t> Slot;
+    std::unique_ptr<Slot[]> m_slots;
+    size_t                  m_size;
+    std::atomic<size_t>     m_count;
+    std::atomic<bool>       m_has_zero;
+};
+
+/** Census of the positions reachable from a position.
+ * The tree of the moves given by \c GameState::for_each_possible_move()
+ * is walked on all the threads, once or twice:
+ * - perft: every node of the tree is counted;
+ * - unique: the positions already met are neither counted nor expanded
+ *   again, thanks to a \c ConcurrentHashSet of their hashes.
+ *
+ * Nodes are counted by ply, along with the terminal ones: the moves
+ * that complete a line (wins), and the moves that fill the board
+ * without completing a line (draws). Terminal nodes are not expanded.
+ * As the number of nodes and their throughput are known, it is also a
+ * benchmark of the move generation.
+ */
+struct Census
+{
+    /// Counts of a ply.
+    struct Counts {
+        Counts() : nodes(0), wins(0), draws(0) {}
+        size_t nodes;
+        size_t wins;
+        size_t draws;
+        Counts & operator+=(Counts const& c) {
+            nodes += c.nodes; wins += c.wins; draws += c.draws;
+            return *this;
+        }
+    };
+    typedef std::vector<Counts> ByPly; ///< index 0 is the first ply
+
+    /** Init constructor.
+     * @param[in] start  position from which the moves are counted
+     * @param[in] first  player who moves first
+     * @param[in] depth  number of plies counted
+     * @param[in] nb_jobs  number of threads
+     * @param[in] set_size_in_MB  size of the set of unique positions
+     */
+    Census(GameState const& start, PlayerId first, size_t depth, size_t nb_jobs, size_t set_size_in_MB)
+        : m_start(start), m_first(first), m_depth(depth)
+        , m_nb_jobs(std::max<size_t>(nb_jobs, 1)), m_set_size(set_size_in_MB)
+        {}
+
+    /** Counts the positions, and prints them.
+     * @param[in] perft  whether every node of the tree is counted too;
+     * the tree grows far faster than the number of positions.
+     * @throw std::runtime_error if the set of unique positions is full.
+     * @throw std::system_error if threads cannot be started.
+     * @throw std::bad_alloc if memory is exhausted.
+     */
+    void run(std::ostream & os, bool perft) const {
+        typedef std::chrono::steady_clock clock;
+        clock::time_point start = clock::now();
+        const ByPly all = perft ? count(nullptr) : ByPly(m_depth);
+        const auto perft_time = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start);
+
+        ConcurrentHashSet set(m_set_size);
+        start = clock::now();
+        const ByPly unique = count(&set);
+        const auto unique_time = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start);
+
+        os << "ply" << (perft ? "        nodes       wins      draws" : "")
+            << "     unique unique-wins unique-draws\n";
+        Counts total, total_unique;
+        for (size_t p=0; p!=m_depth ; ++p) {
+            char line[128];
+            std::snprintf(line, sizeof(line), "%3zu", p+1);
+            os << line;
+            if (perft) {
+                std::snprintf(line, sizeof(line), " %12zu %10zu %10zu", all[p].nodes, all[p].wins, all[p].draws);
+                os << line;
+            }
+            std::snprintf(line, sizeof(line), " %10zu %11zu %12zu\n", unique[p].nodes, unique[p].wins, unique[p].draws);
+            os << line;
+            total += all[p];
+            total_unique += unique[p];
+        }
+        if (perft) {
+            os << "perft: " << total.nodes << " nodes, " << perft_time.count() << "ms, "
+                << size_t(total.nodes * 1e3 / std::max<double>(perft_time.count(), 1)) << " nodes/s\n";
+        }
+        os << "unique: " << total_unique.nodes << " positions, " << unique_time.count() << "ms, "
+            << "set of " << (set.bytes() >> 20) << "MB, "
+            << set.size() * 100 / set.capacity() << "% used\n"
+            << "jobs: " << m_nb_jobs;
+#if HAVE_POSIX
+        struct rusage usage;
+        if (::getrusage(RUSAGE_SELF, &usage) == 0) {
+#  if defined(__APPLE__)
+            const size_t peak = size_t(usage.ru_maxrss);        // bytes
+#  else
+            const size_t peak = size_t(usage.ru_maxrss) << 10;  // kB
+#  endif
+            os << ", peak memory " << (peak >> 20) << "MB";
+        }
+#endif
+        os << "\n";
+    }
+
+private:
+    /// Position from which a thread walks a subtree.
+    struct Task {
+        GameState state;
+        size_t    ply;     ///< plies played from the start
+        PlayerId  player;  ///< player to move
+    };
+
+    /** Walks the tree, with or without a set of the positions met.
+     * The first plies are walked by the current thread, which collects
+     * the positions from which the threads walk the subtrees.
+     */
+    ByPly count(ConcurrentHashSet * set) const {
+        ByPly counts(m_depth);
+        std::vector<Task> tasks;
+        GameState state(m_start);
+        if (set) set->insert(state.hash());
+        walk(state, 0, m_first, set, counts, &tasks);
+
+        std::atomic<size_t> next(0);
+        std::mutex          mutex;
+        std::exception_ptr  error;
+        auto job = [&]() {
+            ByPly job_counts(m_depth);
+            try {
+                for (size_t t ; (t = next++) < tasks.size() ; ) {
+                    Task & task = tasks[t];
+                    walk(task.state, task.ply, task.player, set, job_counts, nullptr);
+                }
+            } catch (...) {
+                next.store(tasks.size());
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t p=0; p!=m_depth ; ++p) counts[p] += job_counts[p];
+        };
+        std::vector<std::thread> threads;
+        try {
+            for (size_t j=1; j < m_nb_jobs ; ++j) threads.emplace_back(job);
+        } catch (...) {
+            next.store(tasks.size());
+            for (auto & t : threads) t.join();
+            throw;
+        }
+        job();
+        for (auto & t : threads) t.join();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return counts;
+    }
+
+    /** Counts the children of a position, and walks their subtrees.
+     * @param[in] tasks  when not null, the children at \c split_ply are
+     * collected instead of being walked
+     */
+    void walk(GameState & g, size_t ply, PlayerId player, ConcurrentHashSet * set,
+            ByPly & counts, std::vector<Task> * tasks) const {
+        PlayerId next = player; next ++;
+        Counts & c = counts[ply];
+        g.for_each_possible_move([&](Move move) -> bool {
+                const bool win = g.is_a_winning_move_for(move, player);
+                g.set(move, player);
+                if (!set || set->insert(g.hash())) {
+                    const bool draw = !win && g.board().empty_squares().none();
+                    c.nodes ++;
+                    c.wins  += win;
+                    c.draws += draw;
+                    if (!win && !draw && ply+1 < m_depth) {
+                        if (tasks && ply+1 == split_ply) {
+                            tasks->push_back(Task{g, ply+1, next});
+                        } else {
+                            walk(g, ply+1, next, set, counts, tasks);
+                        }
+                    }
+                }
+                g.reset(move);
+                return true;
+            });
+    }
+
+    /// Ply from which the subtrees are shared among the threads.
+    static const size_t split_ply = 2;
+
+    const GameState m_start;
+    const PlayerId  m_first;
+    const size_t    m_depth;
+    const size_t    m_nb_jobs;
+    const size_t    m_set_size;
+};
+//@}
+
+/*===========================================================================*/
+/*===============================[ Benchmark ]===============================*/
+/*===========================================================================*/
+/**@defgroup gBench Benchmark
+ * Searches of fixed positions at fixed depths, by every kind of AI
+ * player but the Monte-Carlo one, whose playouts are random. They
+ * measure the speed of the players, and as their results are known,
+ * they also check that optimisations do not change what the players
+ * search. The 8x8 positions are quiet enough for the searches not to be
+ * cut short by the threat pre-search.
+ * @{
+ */
+/// Position of the benchmark, in the format read by \c operator>>().
+struct BenchPosition
+{
+    const char * name;
+    size_t       nb_required_to_win;
+    const char * board;
+};
+
+/** Search of the benchmark, and its expected results.
+ * The expected results are to be updated only by changes that are meant
+ * to change what the players search.
+ */
+struct BenchSearch
+{
+    size_t       position; ///< index in \c bench_positions
+    char         player;   ///< 'n', 'a', 's' or 'p', as on the command line
+    size_t       depth;
+    size_t       nodes;    ///< expected number of nodes
+    Coords       move;     ///< expected move
+};
+
+static const BenchPosition bench_positions[] = {
+    { "3x3, empty", 3,
+        "| | | |\n"
+        "| | | |\n"
+        "| | | |\n" },
+    { "5x5, empty", 4,
+        "| | | | | |\n"
+        "| | | | | |\n"
+        "| | | | | |\n"
+        "| | | | | |\n"
+        "| | | | | |\n" },
+    { "8x8, opening", 4,
+        "|X| | | | | | | |\n"
+        "| |O| | | | | | |\n"
+        "| | |X| | | | | |\n"
+        "| | | | | | | | |\n"
+        "| | | | |O| | | |\n"
+        "| | | | | | | | |\n"
+        "| | | | | | | | |\n"
+        "| | | | | | | | |\n" },
+    { "8x8, quiet", 4,
+        "| | | | | | | | |\n"
+        "| | | | | | | | |\n"
+        "| | |X| | | | | |\n"
+        "| | | | |O| | | |\n"
+        "| | | |O| | | | |\n"
+        "| | | | | |X| | |\n"
+        "| | | | | | | | |\n"
+        "| | | | | | | | |\n" },
+    { "8x8, second move", 4,
+        "| | | | | | | | |\n"
+        "| | | | | | | | |\n"
+        "| | | | | | | | |\n"
+        "| | | |X| | | | |\n"
+        "| | | | | | | | |\n"
+        "| | | | | | | | |\n"
+        "| | | | | | | | |\n"
+        "| | | | | | | | |\n" },
+};
+
+static const BenchSearch bench_searches[] = {
+    { 0, 'n', 8,     47753, Coords{0,0} },
+    { 0, 'a', 8,       696, Coords{1,1} },
+    { 0, 's', 8,       728, Coords{1,1} },
+    { 0, 'p', 8,       240, Coords{1,1} },
+    { 1, 'n', 3,     39124, Coords{2,2} },
+    { 1, 'a', 6,     26934, Coords{2,2} },
+    { 1, 's', 6,     29823, Coords{2,2} },
+    { 2, 'n', 3,   1589400, Coords{2,3} },
+    { 2, 'a', 6,    912417, Coords{2,3} },
+    { 2, 's', 6,    747454, Coords{2,3} },
+    { 2, 'p', 6,      7319, Coords{2,3} },
+    { 3, 'n', 3,   1666466, Coords{2,5} },
+    { 3, 'a', 6,     34707, Coords{2,5} },
+    { 3, 's', 6,     42532, Coords{2,5} },
+    { 3, 'p', 6,     48624, Coords{2,5} },
+    { 4, 'n', 3,    713775, Coords{4,4} },
+    { 4, 'a', 6,     81934, Coords{4,4} },
+    { 4, 's', 6,    148602, Coords{4,4} },
+};
+
+/** Runs the benchmark, and prints its results.
+ * Searches are single-threaded, with a 16MB transposition table, so
+ * that their results are deterministic.
+ * @return whether all the searches gave the expected results.
+ * @throw std::bad_alloc if memory is exhausted.
+ */
+bool run_bench(std::ostream & os)
+{
+    bool   ok          = true;
+    size_t total_nodes = 0;
+    std::chrono::microseconds total_time(0);
+    for (BenchSearch const& b : bench_searches) {
+        BenchPosition const& p = bench_positions[b.position];
+        GameState state(3, 3, p.nb_required_to_win);
+        std::istringstream iss(p.board);
+        iss >> state;
+        Game g(state);
+        g.log_to(nullptr);
+
+        const SearchLimits limits(b.depth);
+        const PlayerId     id = g.next_player();
+        std::unique_ptr<AIPlayerDC> ai;
+        switch (b.player) {
+            case 'n': ai.reset(new NegaMaxPlayerDC(limits, id)); break;
+            case 'a': ai.reset(new NegaMaxPlayerAlphaBetaDC(limits, id)); break;
+            case 's': ai.reset(new NegaScoutPlayerDC(limits, id)); break;
+            case 'p': ai.reset(new ProofNumberPlayerDC(limits, id)); break;
+            default : assert(!"unexpected player");
+        }
+        const Coords move = g.board().coords(ai->choose(g));
+        AIPlayerDC::Stats const& st = ai->stats();
+        total_nodes += st.nodes;
+        total_time  += st.time;
+
+        const bool expected = move == b.move && st.nodes == b.nodes;
+        ok = ok && expected;
+        os << p.name << ", " << b.player << ", depth " << b.depth
+            << ": " << move << ", " << st.nodes << " nodes"
+            << ", " << st.time.count() / 1000 << "ms"
+            << ", " << size_t(st.nodes * 1e6 / std::max<double>(st.time.count(), 1)) << " nps";
+        if (!expected) {
+            os << " -- FAILED, expected " << b.move << ", " << b.nodes << " nodes";
+        }
+        os << "\n";
+    }
+    os << "Total: " << total_nodes << " nodes"
+        << ", " << total_time.count() / 1000 << "ms"
+        << ", " << size_t(total_nodes * 1e6 / std::max<double>(total_time.count(), 1)) << " nps\n";
+    return ok;
+}
+//@}
+
+
+/*===========================================================================*/
+/*=================================[ main ]==================================*/
+/*===========================================================================*/
+/** Program main function.
+ * @param \-\-board to load a file of a game. (optional)
+ * @param \-\-align number of tokens in a row required to win.
+ * (optional, 4 by default)
+ * @param \-\-radius AI players only search the moves at most this
+ * number of rows and columns away from a token; 0 to search all the
+ * moves. (optional, 2 by default)
+ * @param \-\-tt size, in MB, of the transposition table of the next
+ * alpha-beta players, or of the tree of the next MCTS players.
+ * (optional, 16 by default, 0 disables the transposition table)
+ * @param \-\-keep-tree the next MCTS players keep their tree from one
+ * move to the next. (optional)
+ * @param \-\-ponder the next AI players search, during the turns of
+ * their adversary, the position after the reply they expect.
+ * (optional)
+ * @param \-\-cache file of the persistent cache looked up by the next
+ * alpha-beta players, see \c PersistentCache. (optional)
+ * @param \-\-cache-rw file of the persistent cache looked up, and
+ * written to, by the next alpha-beta players; it is created if it does
+ * not exist. (optional)
+ * @param \-\-cache-size size, in MB, of the caches created by the next
+ * \-\-cache-rw. (optional, 256 by default)
+ * @param \-\-lmr number of moves the next alpha-beta players search at
+ * full depth before reducing the quiet ones, see \c Selectivity.
+ * (optional, 0 by default: no reduction)
+ * @param \-\-lmr-depth minimal depth where the next alpha-beta players
+ * reduce the moves. (optional, 3 by default)
+ * @param \-\-extend, \-\-no-extend whether the next alpha-beta players
+ * search the threats one ply deeper. (optional, not by default)
+ * @param \-\-tablebase file of the exact values of the positions,
+ * used by the next alpha-beta players on the boards it matches, see \c
+ * Tablebase. When it does not exist, it is built for the board and the
+ * number of tokens to align set so far; boards are limited to 16
+ * squares. (optional)
+ * @param \-\-pn size, in MB, of the table of the proof numbers of the
+ * next proof-number players, and of \-\-solve. (optional, 64 by
+ * default)
+ * @param \-\-depth maximal depth searched by the next AI players.
+ * (optional)
+ * @param \-\-time time budget, in milliseconds, of the next AI players
+ * for each move. (optional)
+ * @param \-\-nodes maximal number of nodes searched by the next AI
+ * players for each move. (optional)
+ * @param \-\-threads number of threads used by the next AI players.
+ * (optional, 1 by default)
+ * @param \-\-trace file where the next AI players record their
+ * searches, one JSON object per move. (optional)
+ * @param \-\-games number of silent games to play in a batch, instead
+ * of a single commented game. (optional)
+ * @param \-\-jobs number of batch games played at once. (optional, the
+ * number of cores by default)
+ * @param \-\-random number of random moves that open batch games.
+ * (optional, 2 by default)
+ * @param \-\-seed seed of random openings. (optional)
+ * @param \-\-book file of openings for batch games, one per line as
+ * <tt>l c</tt> pairs. (optional)
+ * @param \-\-sprt <tt>elo0,elo1</tt>: the batch games stop as soon as
+ * the \c Sprt tells whether the first player is rather \c elo0 or \c
+ * elo1 Elo points stronger; \-\-games is then their maximal number.
+ * (optional)
+ * @param \-\-tournament \c round-robin or \c gauntlet: the batch games
+ * are played by the pairs of players of a \c Tournament, instead of
+ * two players. (optional)
+ * @param \-\-name name of the next player. (optional)
+ * @param \-\-bench runs the benchmark, alone. Fails if a search does
+ * not give its expected results.
+ * @param \-\-solve proves the value of the position, for the player to
+ * move, instead of playing; within the \-\-nodes and \-\-time
+ * limits, if any. Fails if the value is not proven.
+ * @param \-\-census number of plies over which the positions
+ * reachable from the position are counted, instead of playing; see
+ * \c Census. The moves are the ones the AI players search, see \-\-radius.
+ * The threads are set by \-\-jobs, and the size of the set of unique
+ * positions by \-\-tt.
+ * @param \-\-perft the census also counts every node of the tree of the
+ * moves, perft style. (optional)
+ * @param \-\-analyze file of positions, separated by \c "<<EOF"
+ * lines, to search with the only player given, instead of playing; \c
+ * - for the standard input. The positions are searched by \-\-jobs
+ * jobs at once, and their results are written in the order of the
+ * file, see \c Analysis.
+ * @note Without \-\-depth, \-\-time, nor \-\-nodes, negamax
+ * players search at depth 3, and alpha-beta players at depth 5.
+ * @note For MCTS players, the depth is the number of times the number
+ * of playouts is doubled, 8 by default, and the nodes are the playouts.
+ * @param player1 type of player (n -> negamax, a -> negamax+alpha-beta,
+ * s -> negascout, p -> proof-number, m -> MCTS, h -> human)
+ * @param player2 type of player (n -> negamax, a -> negamax+alpha-beta,
+ * s -> negascout, p -> proof-number, m -> MCTS, h -> human)
+ * @return \c EXIT_SUCCES if the execution succeeded
+ * @return \c EXIT_FAILURE otherwise
+ */
+int main (int argc, char **argv)
+{
+    if (argc == 2 && std::string(argv[1]) == "--bench") {
+        try {
+            return run_bench(std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
+        } catch (std::exception const& e) {
+            std::cerr << e.what() << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+    if (argc < 3) {
+        std::cout << "Usage: " << argv[0] << " [options] <player> <player>"
+            << "\n       " << argv[0] << " --bench"
+            << "\n       " << argv[0] << " [options] --solve"
+            << "\n       " << argv[0] << " [options] --analyze <filename> <player>"
+            << "\n       " << argv[0] << " [options] --census <depth>"
+            << "\n\t[options]"
+            << "\n\t\t--board <filename>"
+            << "\n\t\t--align <nb>        number of tokens in a row required to win"
+            << "\n\t\t--radius <nb>       distance to the tokens of the moves searched (0: all)"
+            << "\n\t\t--tt <MB>           transposition table, or tree, size of next AI players"
+            << "\n\t\t--keep-tree         next MCTS players keep their tree between moves"
+            << "\n\t\t--ponder            next AI players think during the turns of their adversary"
+            << "\n\t\t--cache <filename>  persistent cache read by next alpha-beta players"
+            << "\n\t\t--cache-rw <filename> persistent cache read and written by next alpha-beta players"
+            << "\n\t\t--cache-size <MB>   size of the next caches created (256 by default)"
+            << "\n\t\t--tablebase <filename> exact values used by next alpha-beta players (built if missing)"
+            << "\n\t\t--lmr <nb>          next alpha-beta players reduce the quiet moves after the <nb> first (0: none)"
+            << "\n\t\t--lmr-depth <depth> minimal depth of the reductions (3 by default)"
+            << "\n\t\t--extend            next alpha-beta players extend the threats (--no-extend: they don't)"
+            << "\n\t\t--pn <MB>           proof numbers table size of next solvers"
+            << "\n\t\t--depth <depth>     maximal depth of next AI players"
+            << "\n\t\t--time <ms>         time budget per move of next AI players"
+            << "\n\t\t--nodes <nb>        maximal nodes per move of next AI players"
+            << "\n\t\t--threads <nb>      number of threads of next AI players"
+            << "\n\t\t--trace <filename>  records the searches of next AI players"
+            << "\n\t\t--games <nb>        play a batch of silent games"
+            << "\n\t\t--jobs <nb>         number of batch games played at once"
+            << "\n\t\t--random <nb>       number of random opening moves of batch games"
+            << "\n\t\t--seed <nb>         seed of random openings"
+            << "\n\t\t--book <filename>   openings of batch games"
+            << "\n\t\t--sprt <elo0>,<elo1> stops the batch games once the Elo difference is rather elo0 or elo1"
+            << "\n\t\t--tournament <format> batch games between all the players (round-robin), or the first one and the others (gauntlet)"
+            << "\n\t\t--name <name>       name of the next player"
+            << "\n\t\t--analyze <filename> searches each position of a file (-: stdin)"
+            << "\n\t\t--census <depth>    counts the positions reachable in <depth> plies"
+            << "\n\t\t--perft             the census counts every node of the tree too"
+            << "\n\t<player>"
+            << "\n\t\tn==ai player, (n)egamax"
+            << "\n\t\ta==ai player, negamax-(a)lphabeta"
+            << "\n\t\ts==ai player, negascout (principal variation (s)earch)"
+            << "\n\t\tp==ai player, (p)roof-number search"
+            << "\n\t\tm==ai player, (m)onte-carlo tree search"
+            << "\n\t\th==(h)uman player";
+        return EXIT_FAILURE;
+    }
+    try
+    {
+        Game g(8,8,4);
+        size_t tt_size = 16;
+        size_t pn_size = 64;
+        bool   solve   = false;
+        bool   keep_tree = false;
+        std::string analyze;
+        size_t census  = 0;
+        bool   perft   = false;
+        size_t depth   = 0;
+        size_t nodes   = 0;
+        size_t threads = 1;
+        std::chrono::milliseconds time(0);
+        BatchOptions batch;
+        batch.nb_jobs = std::max<size_t>(1, std::thread::hardware_concurrency());
+        std::vector<PlayerFactory> players;
+        std::vector<std::string>   names;
+        std::string name;
+        std::string tournament;
+        std::shared_ptr<SearchTrace> trace;
+        bool   ponder  = false;
+        std::shared_ptr<PersistentCache> cache;
+        size_t cache_size = 256;
+        std::shared_ptr<const Tablebase> tablebase;
+        Selectivity selectivity;
+        auto traced = [](AIPlayerDC * ai, std::shared_ptr<SearchTrace> const& t, bool p) {
+            std::unique_ptr<PlayerDC> dc(ai);
+            ai->trace_to(t);
+            ai->set_pondering(p);
+            return dc;
+        };
+        // Without any limit, the default depth of each AI is used
+        auto limits = [&](size_t default_depth) {
+            const bool limited = depth || nodes || time.count();
+            return SearchLimits(limited ? depth : default_depth, time, nodes);
+        };
+        // --name applies to the next player only
+        auto named = [&](char const* default_name) {
+            std::string res = name.empty() ? std::string(default_name) : name;
+            name.clear();
+            return res;
+        };
+        auto value_of = [&](int & i) -> std::string {
+            if (i+1 == argc) {
+                throw std::runtime_error(std::string(argv[i]) + " expects a value");
+            }
+            return argv[++i];
+        };
+        for (int i=1; i!=argc ; ++i) {
+            const std::string opt=argv[i];
+            if (opt == "--board" || opt=="-b") {
+                std::ifstream f(argv[++i]);
+                if (!f) {
+                    throw std::runtime_error("Cannot open " + std::string(argv[i]));
+                }
+                f >> g;
+            } else if (opt == "--align") {
+                g.set_nb_required_to_win(std::stoul(value_of(i)));
+            } else if (opt == "--radius") {
+                g.set_candidate_radius(std::stoul(value_of(i)));
+            } else if (opt == "--tt") {
+                tt_size = std::stoul(value_of(i));
+            } else if (opt == "--pn") {
+                pn_size = std::stoul(value_of(i));
+            } else if (opt == "--keep-tree") {
+                keep_tree = true;
+            } else if (opt == "--ponder") {
+                ponder = true;
+            } else if (opt == "--cache" || opt == "--cache-rw") {
+                cache = std::make_shared<PersistentCache>(value_of(i), opt == "--cache-rw", cache_size);
+            } else if (opt == "--cache-size") {
+                cache_size = std::stoul(value_of(i));
+            } else if (opt == "--lmr") {
+                selectivity.lmr_moves = std::stoul(value_of(i));
+            } else if (opt == "--lmr-depth") {
+                selectivity.lmr_depth = std::stoul(value_of(i));
+            } else if (opt == "--extend") {
+                selectivity.extensions = true;
+            } else if (opt == "--no-extend") {
+                selectivity.extensions = false;
+            } else if (opt == "--tablebase") {
+                const std::string filename = value_of(i);
+                if (!std::ifstream(filename)) {
+                    std::cout << "Solving all the positions into " << filename << "..." << std::endl;
+                    Tablebase::build(g.L(), g.C(), g.nb_required_to_win(), filename,
+                            std::max<size_t>(1, std::thread::hardware_concurrency()));
+                }
+                tablebase = std::make_shared<Tablebase>(filename);
+            } else if (opt == "--solve") {
+                solve = true;
+            } else if (opt == "--analyze") {
+                analyze = value_of(i);
+            } else if (opt == "--census") {
+                census = std::stoul(value_of(i));
+            } else if (opt == "--perft") {
+                perft = true;
+            } else if (opt == "--depth") {
+                depth = std::stoul(value_of(i));
+            } else if (opt == "--time") {
+                time = std::chrono::milliseconds(std::stoul(value_of(i)));
+            } else if (opt == "--nodes") {
+                nodes = std::stoul(value_of(i));
+            } else if (opt == "--threads") {
+                threads = std::stoul(value_of(i));
+            } else if (opt == "--games") {
+                batch.nb_games = std::stoul(value_of(i));
+            } else if (opt == "--jobs") {
+                batch.nb_jobs = std::stoul(value_of(i));
+            } else if (opt == "--random") {
+                batch.nb_random_moves = std::stoul(value_of(i));
+            } else if (opt == "--seed") {
+                batch.seed = std::stoull(value_of(i));
+            } else if (opt == "--trace") {
+                trace = std::make_shared<SearchTrace>(value_of(i));
+            } else if (opt == "--book") {
+                const std::string filename = value_of(i);
+                std::ifstream f(filename);
+                if (!f) {
+                    throw std::runtime_error("Cannot open " + filename);
+                }
+                batch.book = read_book(f);
+            } else if (opt == "--sprt") {
+                const std::string elos = value_of(i);
+                const size_t comma = elos.find(',');
+                if (comma == std::string::npos) {
+                    throw std::runtime_error("--sprt expects <elo0>,<elo1>");
+                }
+                batch.sprt.enabled = true;
+                batch.sprt.elo0    = std::stod(elos.substr(0, comma));
+                batch.sprt.elo1    = std::stod(elos.substr(comma+1));
+                if (batch.sprt.elo0 >= batch.sprt.elo1) {
+                    throw std::runtime_error("--sprt expects elo0 < elo1");
+                }
+            } else if (opt == "--tournament") {
+                tournament = value_of(i);
+                if (tournament != "round-robin" && tournament != "gauntlet") {
+                    throw std::runtime_error("Unknown tournament format: " + tournament);
+                }
+            } else if (opt == "--name") {
+                name = value_of(i);
+            } else if (opt == "n" || opt=="negamax") {
+                const SearchLimits l = limits(3);
+                players.push_back([=](PlayerId id) {
+                        return traced(new NegaMaxPlayerDC(l, id, threads), trace, ponder);
+                        });
+                names.push_back(named("(AI-negamax)"));
+            } else if (opt == "a" || opt=="negamax-ab") {
+                const SearchLimits l = limits(5);
+                players.push_back([=](PlayerId id) {
+                        NegaMaxPlayerAlphaBetaDC * ai = new NegaMaxPlayerAlphaBetaDC(l, id, tt_size, threads);
+                        ai->use_cache(cache);
+                        ai->use_tablebase(tablebase);
+                        ai->set_selectivity(selectivity);
+                        return traced(ai, trace, ponder);
+                        });
+                names.push_back(named("(AI-negamax-AB)"));
+            } else if (opt == "s" || opt=="negascout") {
+                const SearchLimits l = limits(5);
+                players.push_back([=](PlayerId id) {
+                        NegaScoutPlayerDC * ai = new NegaScoutPlayerDC(l, id, tt_size, threads);
+                        ai->use_cache(cache);
+                        ai->use_tablebase(tablebase);
+                        ai->set_selectivity(selectivity);
+                        return traced(ai, trace, ponder);
+                        });
+                names.push_back(named("(AI-negascout)"));
+            } else if (opt == "p" || opt=="proof-number") {
+                const SearchLimits l = limits(5);
+                players.push_back([=](PlayerId id) {
+                        ProofNumberPlayerDC * ai = new ProofNumberPlayerDC(l, id, tt_size, pn_size, threads);
+                        ai->use_cache(cache);
+                        ai->use_tablebase(tablebase);
+                        ai->set_selectivity(selectivity);
+                        return traced(ai, trace, ponder);
+                        });
+                names.push_back(named("(AI-proof-number)"));
+            } else if (opt == "m" || opt=="mcts") {
+                const SearchLimits l = limits(8);
+                players.push_back([=](PlayerId id) {
+                        return traced(new MCTSPlayerDC(l, id, tt_size, keep_tree, threads), trace, ponder);
+                        });
+                names.push_back(named("(AI-mcts)"));
+            } else if (opt == "h" || opt=="human") {
+                players.push_back([](PlayerId) {
+                        return std::unique_ptr<PlayerDC>(new LocalPlayerDC());
+                        });
+                names.push_back(named("(Human)"));
+            } else {
+                players.push_back([](PlayerId) {
+                        return std::unique_ptr<PlayerDC>(new LocalPlayerDC());
+                        });
+                names.push_back("opt");
+                // std::cerr << argv[0] << ": invalid option != i/h\n";
+                // return EXIT_FAILURE;
+            }
+        }
+
+        if (solve) {
+            typedef ProofNumberPlayerDC PN;
+            typedef std::chrono::steady_clock clock;
+            const clock::time_point start = clock::now();
+            const PN solver(SearchLimits(), g.next_player(), 0, pn_size);
+            const PN::Solution s = solver.solve(g, nodes, time);
+            const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start);
+            std::cout << g.board() << "Player " << size_t(g.next_player());
+            std::ostringstream at;
+            if (s.move == no_move) {
+                at << ", no move";
+            } else {
+                at << ", at " << g.board().coords(s.move);
+            }
+            switch (s.value) {
+                case PN::Value::win:     std::cout << " wins" << at.str(); break;
+                case PN::Value::draw:    std::cout << " draws" << at.str(); break;
+                case PN::Value::loss:    std::cout << " loses"; break;
+                case PN::Value::unknown: std::cout << ": unknown result"; break;
+            }
+            std::cout << " (" << s.nodes << " nodes, " << elapsed.count() << "ms)\n";
+            return s.value == PN::Value::unknown ? EXIT_FAILURE : EXIT_SUCCESS;
+        }
+
+        if (census) {
+            Census(g, g.next_player(), census, batch.nb_jobs, tt_size).run(std::cout, perft);
+            return EXIT_SUCCESS;
+        }
+
+        if (!analyze.empty()) {
+            if (players.size() != 1) {
+                throw std::runtime_error("An analysis expects one player");
+            }
+            Analysis a(g, players[0], batch.nb_jobs);
+            if (analyze == "-") {
+                a.run(std::cin, std::cout);
+            } else {
+                std::ifstream f(analyze);
+                if (!f) {
+                    throw std::runtime_error("Cannot open " + analyze);
+                }
+                a.run(f, std::cout);
+            }
+            return EXIT_SUCCESS;
+        }
+
+        if (!tournament.empty()) {
+            if (!batch.nb_games) {
+                throw std::runtime_error("A tournament expects --games");
+            }
+            Tournament t(g, std::move(players), std::move(names),
+                    tournament == "gauntlet" ? Tournament::Format::gauntlet : Tournament::Format::round_robin,
+                    std::move(batch));
+            t.run(std::cout);
+            return EXIT_SUCCESS;
+        }
+
+        if (batch.nb_games) {
+            if (players.size() != 2) {
+                throw std::runtime_error("A batch of games expects two players");
+            }
+            Batch b(g, {{players[0], players[1]}}, {{names[0], names[1]}}, std::move(batch));
+            b.run(std::cout);
+            return EXIT_SUCCESS;
+        }
+
+        if (players.size() != 2) {
+            throw std::runtime_error("A game expects two players");
+        }
+        PlayerId id = PlayerId::first;
+        for (size_t p = 0; p != players.size() ; ++p, id++) {
+            g.push(players[p](id), std::move(names[p]));
+        }
+        // scenario
+#if 0
+        g.set(Move(g.board().index(0, 0)), PlayerId::first);
+        g.set(Move(g.board().index(1, 1)), PlayerId::second);
+        g.set(Move(g.board().index(0, 1)), PlayerId::first);
+        g.set(Move(g.board().index(0, 2)), PlayerId::second);
+#endif
+
+        std::cout << g.board();
+        g.run();
+    } catch (std::exception const& e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+}
+// Vim: let $CXXFLAGS='-std=c++0x -g -pedantic -Wall -pthread'